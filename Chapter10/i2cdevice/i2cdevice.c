@@ -23,6 +23,7 @@
 #include "hardware/i2c.h"
 #include "hardware/rtc.h"
 #include <pico/i2c_slave.h>
+#include "epoch.h"
 
 // Semaphore to indicate that the device is ready
 static semaphore_t sem_device;
@@ -119,7 +120,7 @@ void i2cDevice() {
     dt.month = 3;
     dt.day = 3;
     dt.year = 2023;
-    dt.dotw = 5;
+    dt.dotw = epoch_dotw(dt.year, dt.month, dt.day);
     dt.hour = 21;
     dt.min = 0;
     dt.sec = 0;
@@ -128,8 +129,8 @@ void i2cDevice() {
     printf ("RTC started\n");
     sleep_ms(100);
     rtc_get_datetime(&dt);
-    printf ("Current date: %02d/%02d/%04d %02d:%02d:%02d\n", dt.month, 
-            dt.day, dt.year, dt.hour, dt.min, dt.sec);
+    char iso[EPOCH_ISO_SIZE];
+    printf ("Current date: %s\n", epoch_format_iso(&dt, iso));
 
     // Set up device I2C
     uint baud = i2c_init (I2C_SLAVE_ID, I2C_BAUDRATE);
@@ -158,8 +159,7 @@ void i2cDevice() {
 
             // Show new date and time
             rtc_get_datetime(&dt);
-            printf ("New date: %02d/%02d/%04d %02d:%02d:%02d\n", dt.month, 
-                    dt.day, dt.year, dt.hour, dt.min, dt.sec);
+            printf ("New date: %s\n", epoch_format_iso(&dt, iso));
             update = false;
             updating = false;
         }
@@ -226,8 +226,8 @@ int main() {
             }
 
             // Show date and time
-            printf ("RTC: %02d/%02d/%04d %02d:%02d:%02d\n", dt.month, 
-                    dt.day, dt.year, dt.hour, dt.min, dt.sec);
+            char iso[EPOCH_ISO_SIZE];
+            printf ("RTC: %s\n", epoch_format_iso(&dt, iso));
         } else {
             // Get new date and time
             int dig[14];
@@ -244,10 +244,14 @@ int main() {
             dt.month = dig[0]*10+dig[1];
             dt.day = dig[2]*10+dig[3];
             dt.year = dig[4]*1000+dig[5]*100+dig[6]*10+dig[7];
-            dt.dotw = 0;
             dt.hour = dig[8]*10+dig[9];
             dt.min = dig[10]*10+dig[11];
             dt.sec = dig[12]*10+dig[13];
+            if (!epoch_valid(&dt)) {
+                printf("Invalid date and time\n");
+                continue;
+            }
+            dt.dotw = epoch_dotw(dt.year, dt.month, dt.day);
 
             // Wait for RTC ready
             while (true) {
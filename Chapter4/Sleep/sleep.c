@@ -18,14 +18,34 @@
 
 #include "hardware/gpio.h"
 #include "hardware/rtc.h"
+#include "clkgating.h"
+
+#include "vdebounce.h"
 
 // GPIO connections
 #define LED   0
 #define BTN1  2
 #define BTN2  4
-
-// For button detection and debounce
-typedef enum { NOT_PRESSED, DBC_PRESS, PRESSED, DBC_RELEASE } BTN_STATE;
+#define BTN_MASK  ((1u << BTN1) | (1u << BTN2))
+
+// Buttons are sampled every BTN_SAMPLE_MS, the debounce
+// takes VDEBOUNCE_SAMPLES samples
+#define BTN_SAMPLE_MS   10
+
+// Set to 0 to keep all peripherals clocked (to compare the current)
+#define CLOCK_GATING    1
+
+// Only clock the blocks we use (ROSC and RTC besides the core ones)
+// Running from XOSC, the PLLs and USB are not needed
+// sleep_goto_sleep_until() changes SLEEP_EN, so this must be
+// called again after waking up
+static void clock_gating(void) {
+    #if CLOCK_GATING
+    clkgating_enable(CLOCKS_WAKE_EN0_CLK_SYS_ROSC_BITS |
+                     CLOCKS_WAKE_EN0_CLK_SYS_RTC_BITS |
+                     CLOCKS_WAKE_EN0_CLK_RTC_RTC_BITS, 0);
+    #endif
+}
 
 // Aux routine to ger milliseconds since boot
 static inline uint32_t board_millis(void) {
@@ -56,6 +76,9 @@ static void rtc_sleep(void) {
     // Sleep 5 seconds
     t.sec = 5;
     sleep_goto_sleep_until(&t, &sleep_callback);
+
+    // Restore our clock gating profile
+    clock_gating();
 }
 
 
@@ -65,6 +88,9 @@ int main() {
     // We will run from XOSC
     sleep_run_from_xosc();
 
+    // Turn off the clocks of the unused peripherals
+    clock_gating();
+
     // Init the GPIO pins
      gpio_init(LED);
      gpio_set_dir(LED, true);
@@ -78,9 +104,9 @@ int main() {
     // Main loop
     uint32_t ledTime = board_millis();
     bool ledValue = false;
-    BTN_STATE btn1State = NOT_PRESSED;
-    BTN_STATE btn2State = NOT_PRESSED;
-    uint32_t btnTime;
+    VDEBOUNCE buttons;
+    vdebounce_init(&buttons, 0);
+    uint32_t btnTime = board_millis();
     while (true) {
         // Blink LED every 300 ms (if awake)
         if (board_millis() > ledTime) {
@@ -89,69 +115,24 @@ int main() {
             ledTime = board_millis() + 300;
         }
 
-        // Check button 1
-        if (btn2State == NOT_PRESSED) {
-            switch (btn1State) {
-                case NOT_PRESSED:
-                    if (!gpio_get(BTN1)) {
-                        btn1State = DBC_PRESS;
-                        btnTime = board_millis() + 100;
-                    }
-                    break;
-                case DBC_PRESS:
-                    if (board_millis() > btnTime) {
-                        btn1State = PRESSED;
-                    }
-                    break;
-                case PRESSED:
-                    if (gpio_get(BTN1)) {
-                        btn1State = DBC_RELEASE;
-                        btnTime = board_millis() + 100;
-                    }
-                    break;
-                case DBC_RELEASE:
-                    if (board_millis() > btnTime) {
-                        btn1State = NOT_PRESSED;
-                        // Button was pressed and released
-                        // Sleep
-                        gpio_put(LED, false);
-                        rtc_sleep();
-                    }
-                    break;
-            }
-        }
-
-        // Check button 2
-        if (btn1State == NOT_PRESSED) {
-            switch (btn2State) {
-                case NOT_PRESSED:
-                    if (!gpio_get(BTN2)) {
-                        btn2State = DBC_PRESS;
-                        btnTime = board_millis() + 100;
-                    }
-                    break;
-                case DBC_PRESS:
-                    if (board_millis() > btnTime) {
-                        btn2State = PRESSED;
-                    }
-                    break;
-                case PRESSED:
-                    if (gpio_get(BTN2)) {
-                        btn2State = DBC_RELEASE;
-                        btnTime = board_millis() + 100;
-                    }
-                    break;
-                case DBC_RELEASE:
-                    if (board_millis() > btnTime) {
-                        btn2State = NOT_PRESSED;
-                        // Button was pressed and released
-                        // Put in dormant mode until button 1 is released
-                        gpio_put(LED, false);
-                        sleep_goto_dormant_until_pin(BTN1, true, true);
-                        // Give some time for BTN1 release debounce
-                        busy_wait_ms(100);
-                    }
-                    break;
+        // Sample the buttons (pressed = low)
+        if (board_millis() > btnTime) {
+            btnTime = board_millis() + BTN_SAMPLE_MS;
+            uint32_t changed = vdebounce_update(&buttons, ~gpio_get_all() & BTN_MASK);
+            uint32_t released = vdebounce_released(&buttons, changed);
+            if ((released & (1u << BTN1)) && !(buttons.state & (1u << BTN2))) {
+                // Button 1 was pressed and released
+                // Sleep
+                gpio_put(LED, false);
+                rtc_sleep();
+            } else if ((released & (1u << BTN2)) && !(buttons.state & (1u << BTN1))) {
+                // Button 2 was pressed and released
+                // Put in dormant mode until button 1 is released
+                gpio_put(LED, false);
+                sleep_goto_dormant_until_pin(BTN1, true, true);
+                // Give some time for BTN1 release debounce
+                busy_wait_ms(100);
+                vdebounce_init(&buttons, 0);
             }
         }
 
@@ -0,0 +1,72 @@
+/**
+ * @file bench.c
+ * @author Daniel Quadros
+ * @brief Benchmark of the spidma.c rendering and refresh in the host
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ * spidma.c is compiled with its main() renamed, the refreshes are
+ * done by calling the emulator instead of waiting for the timer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lcdemu.h"
+
+// Routines and variables from spidma.c
+extern uint sm;
+extern critical_section_t cs_frames;
+void initStrips(void);
+void initDMA(void);
+void displayInit(void);
+void displayStart(void);
+int frameGet(void);
+void drawFrame(int s);
+void framePresent(int buf, int top, int bottom);
+
+// Number of frames to draw
+#define N_FRAMES 100000
+
+// Current time in nanoseconds
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// Main Program
+int main(int argc, char *argv[]) {
+    int nFrames = (argc > 1) ? atoi(argv[1]) : N_FRAMES;
+
+    // Same initialization as spidma.c, without starting the timer
+    sm = pio_claim_unused_sm(pio0, true);
+    critical_section_init(&cs_frames);
+    initStrips();
+    initDMA();
+    displayInit();
+    displayStart();
+
+    // Time drawing and refreshing
+    uint64_t drawTime = 0;
+    uint64_t refreshTime = 0;
+    for (int i = 0; i < nFrames; i++) {
+        uint64_t t0 = now_ns();
+        int buf = frameGet();
+        drawFrame(buf);
+        uint64_t t1 = now_ns();
+        framePresent(buf, i & 1, (i & 2) >> 1);
+        lcdemu_refresh();
+        uint64_t t2 = now_ns();
+        drawTime += t1 - t0;
+        refreshTime += t2 - t1;
+    }
+
+    printf("Frames:  %d\n", nFrames);
+    printf("Draw:    %.1f ns/frame\n", (double) drawTime / nFrames);
+    printf("Refresh: %.1f ns/frame\n", (double) refreshTime / nFrames);
+    return 0;
+}
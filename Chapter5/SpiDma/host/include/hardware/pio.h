@@ -0,0 +1,2 @@
+// Host version of the SDK header, see lcdemu.h
+#include "lcdemu.h"
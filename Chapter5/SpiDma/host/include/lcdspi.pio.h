@@ -0,0 +1,24 @@
+// Host version of the header generated from lcdspi.pio, see lcdemu.h
+#include "lcdemu.h"
+
+static const pio_program_t lcdspi_program;
+
+static inline void lcdspi_program_init(PIO pio, uint sm, uint offset,
+    uint dataPin, uint clockPin, uint dcPin, float freq) {
+    (void) pio; (void) sm; (void) offset;
+    (void) dataPin; (void) clockPin; (void) dcPin; (void) freq;
+}
+
+static inline void lcdspi_put_blocking(PIO pio, uint sm, uint8_t b) {
+    lcdemu_pio_put(pio, sm, b);
+}
+
+static inline void lcdspi_run_blocking(PIO pio, uint sm, bool dc,
+    const uint8_t *data, uint len) {
+    lcdspi_put_blocking(pio, sm, dc ? 1 : 0);
+    lcdspi_put_blocking(pio, sm, (len-1) >> 8);
+    lcdspi_put_blocking(pio, sm, (len-1) & 0xFF);
+    while (len--) {
+        lcdspi_put_blocking(pio, sm, *data++);
+    }
+}
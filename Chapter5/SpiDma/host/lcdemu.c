@@ -0,0 +1,422 @@
+/**
+ * @file lcdemu.c
+ * @author Daniel Quadros
+ * @brief Host emulation of the SDK functions used by spidma.c
+ *        The DMA chain is followed and the bytes sent to the PIO
+ *        are decoded by a model of the Nokia 5110 controller
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ * Environment variables:
+ *   LCDEMU_FRAMES  number of refreshes before exiting (default 20)
+ *   LCDEMU_PPM     name for the PPM files, with a %d for the
+ *                  refresh number (default "frame%03d.ppm",
+ *                  empty to disable the dumps)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lcdemu.h"
+
+// Control blocks as declared in spidma.c
+// The size of the pointer in the host is not 32 bits, so
+// the DMA will copy whole control blocks
+typedef struct {uint32_t len; const char *data;} lcdemu_block_t;
+
+// PCD8544 (Nokia 5110 controller) model
+#define LCD_BANKS   (LCDEMU_DY/8)
+static uint8_t lcdRam[LCD_BANKS][LCDEMU_DX];
+static int lcdX, lcdY;
+static bool lcdExtended;     // H bit
+static bool lcdVertical;     // V bit
+static int lcdMode;          // D and E bits
+
+// Run decoder for the PIO program
+static int runHeader = 0;    // header bytes received
+static bool runData;         // D/C level
+static uint32_t runCount;    // data bytes still to receive
+
+// DMA channels
+typedef struct {
+    bool claimed;
+    dma_channel_config cfg;
+    volatile void *write;
+    const volatile void *read;
+    uint reload;             // transfer count used when triggered
+    bool irq0;
+} lcdemu_chan_t;
+static lcdemu_chan_t chan[NUM_DMA_CHANNELS];
+static uint timerNum = 1, timerDen = 1;
+static bool timerClaimed;
+
+// Channels waiting to be triggered
+static uint pending[NUM_DMA_CHANNELS];
+static int nPending = 0;
+
+// IRQ
+static irq_handler_t dmaIrqHandler;
+static bool dmaIrqEnabled;
+
+// Emulated hardware
+pio_hw_t lcdemu_pio0;
+dma_hw_t lcdemu_dma;
+
+// Virtual time and pacing
+static uint64_t now_us = 0;
+static int paceChan = -1;
+static uint64_t nextPace;
+static uint32_t refreshes = 0;
+
+// Configuration
+static uint32_t maxFrames = 20;
+static const char *ppmName = "frame%03d.ppm";
+
+
+/* ---------------- LCD model ---------------- */
+
+// Execute a command
+static void lcd_command(uint8_t cmd) {
+    if ((cmd & 0xF8) == 0x20) {
+        // Function set (in both instruction sets)
+        lcdExtended = (cmd & 0x01) != 0;
+        lcdVertical = (cmd & 0x02) != 0;
+    } else if (lcdExtended) {
+        // Temperature, bias and Vop do not change the RAM
+    } else if ((cmd & 0xF8) == 0x08) {
+        lcdMode = ((cmd & 0x04) >> 1) | (cmd & 0x01);
+    } else if ((cmd & 0xF8) == 0x40) {
+        if ((cmd & 0x07) < LCD_BANKS) {
+            lcdY = cmd & 0x07;
+        }
+    } else if (cmd & 0x80) {
+        if ((cmd & 0x7F) < LCDEMU_DX) {
+            lcdX = cmd & 0x7F;
+        }
+    }
+}
+
+// Write data to the RAM, advancing the address
+static void lcd_data(uint8_t data) {
+    lcdRam[lcdY][lcdX] = data;
+    if (lcdVertical) {
+        if (++lcdY == LCD_BANKS) {
+            lcdY = 0;
+            if (++lcdX == LCDEMU_DX) {
+                lcdX = 0;
+            }
+        }
+    } else {
+        if (++lcdX == LCDEMU_DX) {
+            lcdX = 0;
+            if (++lcdY == LCD_BANKS) {
+                lcdY = 0;
+            }
+        }
+    }
+}
+
+// Get a pixel as seen in the glass
+bool lcdemu_pixel(int x, int y) {
+    bool on = (lcdRam[y >> 3][x] >> (y & 7)) & 1;
+    switch (lcdMode) {
+        case 0: return false;   // blank
+        case 1: return true;    // all segments on
+        case 3: return !on;     // inverse
+        default: return on;     // normal
+    }
+}
+
+// Write the display RAM as a PPM file, each pixel is 4x4
+#define PPM_SCALE 4
+bool lcdemu_dump_ppm(const char *fname) {
+    FILE *f = fopen(fname, "wb");
+    if (f == NULL) {
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", LCDEMU_DX*PPM_SCALE, LCDEMU_DY*PPM_SCALE);
+    for (int y = 0; y < LCDEMU_DY*PPM_SCALE; y++) {
+        for (int x = 0; x < LCDEMU_DX*PPM_SCALE; x++) {
+            static const uint8_t on[3] = { 0x20, 0x30, 0x20 };
+            static const uint8_t off[3] = { 0x90, 0xB0, 0x80 };
+            fwrite(lcdemu_pixel(x/PPM_SCALE, y/PPM_SCALE) ? on : off, 1, 3, f);
+        }
+    }
+    return fclose(f) == 0;
+}
+
+
+/* ---------------- PIO ---------------- */
+
+uint pio_claim_unused_sm(PIO pio, bool required) {
+    (void) pio; (void) required;
+    return 0;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program) {
+    (void) pio; (void) program;
+    return 0;
+}
+
+// Decode the runs sent to the PIO program
+void lcdemu_pio_put(PIO pio, uint sm, uint8_t b) {
+    (void) pio; (void) sm;
+    if (runHeader == 0) {
+        runData = b != 0;
+        runCount = 0;
+        runHeader++;
+    } else if (runHeader < 3) {
+        runCount = (runCount << 8) | b;
+        if (++runHeader == 3) {
+            runCount++;
+        }
+    } else {
+        if (runData) {
+            lcd_data(b);
+        } else {
+            lcd_command(b);
+        }
+        if (--runCount == 0) {
+            runHeader = 0;
+        }
+    }
+}
+
+
+/* ---------------- DMA ---------------- */
+
+int dma_claim_unused_channel(bool required) {
+    for (int ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        if (!chan[ch].claimed) {
+            chan[ch].claimed = true;
+            return ch;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "lcdemu: no free DMA channel\n");
+        exit(1);
+    }
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c = {
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .dreq = DREQ_FORCE,     // permanent request
+        .chain_to = channel,    // no chaining
+        .irq_quiet = false
+    };
+    return c;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config,
+    volatile void *write_addr, const volatile void *read_addr,
+    uint transfer_count, bool trigger) {
+    chan[channel].cfg = *config;
+    chan[channel].write = write_addr;
+    chan[channel].read = read_addr;
+    chan[channel].reload = transfer_count;
+    if (trigger) {
+        dma_channel_start(channel);
+    }
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    chan[channel].irq0 = enabled;
+}
+
+int dma_claim_unused_timer(bool required) {
+    if (timerClaimed) {
+        if (required) {
+            fprintf(stderr, "lcdemu: no free DMA timer\n");
+            exit(1);
+        }
+        return -1;
+    }
+    timerClaimed = true;
+    return 0;
+}
+
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator) {
+    (void) timer;
+    timerNum = numerator;
+    timerDen = denominator;
+}
+
+// Check if an address is a register of a DMA channel
+static int dma_reg_chan(volatile void *addr) {
+    for (int ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        if ((addr == &dma_hw->ch[ch].al3_transfer_count) ||
+            (addr == &dma_hw->ch[ch].al3_read_addr_trig)) {
+            return ch;
+        }
+    }
+    return -1;
+}
+
+// Do the transfers of a channel
+static void dma_run(uint ch) {
+    lcdemu_chan_t *c = &chan[ch];
+    uint count = c->reload;
+    int target = dma_reg_chan(c->write);
+
+    if (count == 0) {
+        // Null trigger
+        if (c->cfg.irq_quiet && c->irq0) {
+            dma_hw->ints0 |= 1u << ch;
+            if (dmaIrqEnabled && (dmaIrqHandler != NULL)) {
+                dmaIrqHandler();
+            }
+        }
+        return;
+    }
+
+    if ((target >= 0) && (c->write == &dma_hw->ch[target].al3_transfer_count)) {
+        // Control channel loading a control block
+        const lcdemu_block_t *cb = (const lcdemu_block_t *) c->read;
+        chan[target].reload = cb->len;
+        chan[target].read = cb->data;
+        c->read = cb + 1;
+        pending[nPending++] = target;
+    } else if (target >= 0) {
+        // Writing a new read address and triggering
+        const void * const *p = (const void * const *) c->read;
+        chan[target].read = *p;
+        if (c->cfg.read_increment) {
+            c->read = p + 1;
+        }
+        pending[nPending++] = target;
+    } else if ((c->write >= (volatile void *) &lcdemu_pio0.txf[0]) &&
+               (c->write <= (volatile void *) &lcdemu_pio0.txf[3])) {
+        // Sending data to the PIO
+        const volatile uint8_t *p = c->read;
+        uint sm = (volatile uint32_t *) c->write - lcdemu_pio0.txf;
+        for (uint i = 0; i < count; i++) {
+            lcdemu_pio_put(pio0, sm, *p);
+            p += c->cfg.read_increment ? (1 << c->cfg.size) : 0;
+        }
+        c->read = p;
+    } else {
+        // Writes to other places are ignored
+    }
+
+    // Chain to another channel
+    if (c->cfg.chain_to != ch) {
+        pending[nPending++] = c->cfg.chain_to;
+    }
+}
+
+// Trigger a channel and the ones it triggers or chains to
+static void dma_trigger(uint ch) {
+    pending[nPending++] = ch;
+    while (nPending > 0) {
+        ch = pending[0];
+        memmove(&pending[0], &pending[1], (--nPending)*sizeof(pending[0]));
+        if ((chan[ch].cfg.dreq >= DREQ_DMA_TIMER0) &&
+            (chan[ch].cfg.dreq <= DREQ_DMA_TIMER3)) {
+            // Paced by the timer: finishes in the future
+            paceChan = ch;
+            nextPace = now_us + ((uint64_t) chan[ch].reload * timerDen * 1000000u) /
+                                ((uint64_t) clock_get_hz(clk_sys) * timerNum);
+            continue;
+        }
+        dma_run(ch);
+    }
+}
+
+void dma_channel_start(uint channel) {
+    dma_trigger(channel);
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    if (num == DMA_IRQ_0) {
+        dmaIrqHandler = handler;
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    if (num == DMA_IRQ_0) {
+        dmaIrqEnabled = enabled;
+    }
+}
+
+// The pacing channel has finished
+static void pace_done(void) {
+    int ch = paceChan;
+    paceChan = -1;
+    if (chan[ch].cfg.chain_to != (uint) ch) {
+        dma_trigger(chan[ch].cfg.chain_to);
+    }
+    refreshes++;
+    if ((ppmName != NULL) && (*ppmName != 0)) {
+        char fname[256];
+        snprintf(fname, sizeof(fname), ppmName, refreshes);
+        lcdemu_dump_ppm(fname);
+    }
+    if (refreshes >= maxFrames) {
+        fflush(stdout);
+        exit(0);
+    }
+}
+
+// Run the refresh chain once, as if the pacing channel finished
+void lcdemu_refresh(void) {
+    if (paceChan >= 0) {
+        int ch = paceChan;
+        paceChan = -1;
+        dma_trigger(chan[ch].cfg.chain_to);
+    }
+}
+
+uint32_t lcdemu_refreshes(void) {
+    return refreshes;
+}
+
+
+/* ---------------- Time ---------------- */
+
+// Advance the virtual time, doing the refreshes
+static void advance(uint64_t us) {
+    uint64_t target = now_us + us;
+    while ((paceChan >= 0) && (nextPace <= target)) {
+        now_us = nextPace;
+        pace_done();
+    }
+    now_us = target;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t) now_us;
+}
+
+void sleep_ms(uint32_t ms) {
+    advance((uint64_t) ms * 1000u);
+}
+
+void tight_loop_contents(void) {
+    advance(1);
+}
+
+// Wait for the next interrupt (the end of the next refresh)
+void __wfi(void) {
+    advance((paceChan >= 0) && (nextPace > now_us) ? nextPace - now_us : 1);
+}
+
+
+/* ---------------- stdio ---------------- */
+
+void stdio_init_all(void) {
+    const char *env = getenv("LCDEMU_FRAMES");
+    if (env != NULL) {
+        maxFrames = strtoul(env, NULL, 10);
+    }
+    env = getenv("LCDEMU_PPM");
+    if (env != NULL) {
+        ppmName = env;
+    }
+}
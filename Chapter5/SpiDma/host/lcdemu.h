@@ -0,0 +1,141 @@
+/**
+ * @file lcdemu.h
+ * @author Daniel Quadros
+ * @brief Host emulation of the SDK functions used by spidma.c
+ *        The DMA chain is followed and the bytes sent to the PIO
+ *        are decoded by a model of the Nokia 5110 controller
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _LCDEMU_H
+#define _LCDEMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// Time
+// The emulation uses a virtual time, advanced by sleep_ms() and
+// while waiting for interrupts
+uint32_t time_us_32(void);
+void sleep_ms(uint32_t ms);
+void tight_loop_contents(void);
+void __wfi(void);
+
+// stdio
+void stdio_init_all(void);
+
+// Critical sections (there are no interrupts in the host)
+typedef struct { int dummy; } critical_section_t;
+static inline void critical_section_init(critical_section_t *cs) { (void) cs; }
+static inline void critical_section_enter_blocking(critical_section_t *cs) { (void) cs; }
+static inline void critical_section_exit(critical_section_t *cs) { (void) cs; }
+
+// GPIO (ignored)
+static inline void gpio_init(uint gpio) { (void) gpio; }
+static inline void gpio_set_dir(uint gpio, bool out) { (void) gpio; (void) out; }
+static inline void gpio_put(uint gpio, bool value) { (void) gpio; (void) value; }
+
+// Clocks
+enum clock_index { clk_sys };
+static inline uint32_t clock_get_hz(enum clock_index clk) { (void) clk; return 125000000; }
+
+// IRQ
+#define DMA_IRQ_0 11
+typedef void (*irq_handler_t)(void);
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+// PIO
+// Only the TX FIFOs are modeled, writes to them go to the LCD
+typedef struct { volatile uint32_t txf[4]; } pio_hw_t;
+typedef pio_hw_t *PIO;
+typedef struct { int dummy; } pio_program_t;
+extern pio_hw_t lcdemu_pio0;
+#define pio0 (&lcdemu_pio0)
+uint pio_claim_unused_sm(PIO pio, bool required);
+uint pio_add_program(PIO pio, const pio_program_t *program);
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    (void) pio; (void) is_tx; return sm;
+}
+void lcdemu_pio_put(PIO pio, uint sm, uint8_t b);
+
+// DMA
+// Only the registers used by spidma are modeled
+#define NUM_DMA_CHANNELS 12
+typedef struct {
+    volatile uint32_t al3_transfer_count;
+    volatile uint32_t al3_read_addr_trig;
+} dma_channel_hw_t;
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+    volatile uint32_t ints0;
+} dma_hw_t;
+extern dma_hw_t lcdemu_dma;
+#define dma_hw (&lcdemu_dma)
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+typedef struct {
+    uint size;
+    bool read_increment;
+    bool write_increment;
+    uint dreq;
+    uint chain_to;
+    bool irq_quiet;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c,
+    enum dma_channel_transfer_size size) { c->size = size; }
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    c->read_increment = incr;
+}
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    c->write_increment = incr;
+}
+static inline void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits) {
+    (void) c; (void) write; (void) size_bits;
+}
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) { c->dreq = dreq; }
+static inline void channel_config_set_chain_to(dma_channel_config *c, uint chain_to) {
+    c->chain_to = chain_to;
+}
+static inline void channel_config_set_irq_quiet(dma_channel_config *c, bool quiet) {
+    c->irq_quiet = quiet;
+}
+void dma_channel_configure(uint channel, const dma_channel_config *config,
+    volatile void *write_addr, const volatile void *read_addr,
+    uint transfer_count, bool trigger);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_start(uint channel);
+int dma_claim_unused_timer(bool required);
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator);
+#define DREQ_DMA_TIMER0 59
+#define DREQ_DMA_TIMER3 62
+#define DREQ_FORCE      63
+static inline uint dma_get_timer_dreq(uint timer_num) { return DREQ_DMA_TIMER0 + timer_num; }
+
+// Emulator control
+#define LCDEMU_DX   84
+#define LCDEMU_DY   48
+
+// Run the refresh chain once, as if the pacing channel finished
+void lcdemu_refresh(void);
+
+// Number of refreshes done
+uint32_t lcdemu_refreshes(void);
+
+// Write the display RAM as a PPM file
+bool lcdemu_dump_ppm(const char *fname);
+
+// Get a pixel from the display RAM
+bool lcdemu_pixel(int x, int y);
+
+#endif
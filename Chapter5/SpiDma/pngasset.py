@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+#
+# pngasset.py - PNG to compressed LCD asset converter
+# Example for 'Knowing the RP2040' book
+# Copyright (c) 2026, Daniel Quadros
+#
+# Converts PNG images to the format of the Nokia 5110 display memory
+# (each byte controls 8 vertical pixels, LSB at the top) and compresses
+# them. The result is a C header with the assets as const arrays.
+#
+# Usage: pngasset.py -o output.h name=image.png [name=image.png ...]
+#
+# Compressed format (a sequence of tokens):
+#   0nnnnnnn                 n+1 literal bytes follow
+#   10nnnnnn b               byte b repeated n+2 times
+#   11nnnnnn d               copy n+3 bytes starting d+1 bytes back
+#
+# Dark pixels (and not transparent) are on.
+#
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAX_LITERAL = 128
+MAX_REPEAT = 65
+MAX_COPY = 66
+MAX_DISTANCE = 256
+
+
+def read_png(fname):
+    """Decode a non interlaced PNG, returns (width, height, rows of on/off)"""
+    with open(fname, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError(fname + ': not a PNG file')
+
+    # Get the chunks we need
+    pos = 8
+    idat = b''
+    palette = None
+    trns = None
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos+8])
+        chunk = data[pos+8:pos+8+length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, ctype, _, _, interlace = \
+                struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'PLTE':
+            palette = [tuple(chunk[i:i+3]) for i in range(0, len(chunk), 3)]
+        elif kind == b'tRNS':
+            trns = chunk
+        elif kind == b'IDAT':
+            idat += chunk
+        elif kind == b'IEND':
+            break
+    if interlace != 0:
+        raise ValueError(fname + ': interlaced PNG not supported')
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[ctype]
+    bpp = max(1, channels * depth // 8)
+    stride = (width * channels * depth + 7) // 8
+
+    # Undo the filters
+    raw = zlib.decompress(idat)
+    rows = []
+    prev = bytearray(stride)
+    pos = 0
+    for _ in range(height):
+        ftype = raw[pos]
+        line = bytearray(raw[pos+1:pos+1+stride])
+        pos += 1 + stride
+        for i in range(stride):
+            a = line[i-bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i-bpp] if i >= bpp else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xFF
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if (pa <= pb and pa <= pc) else (b if pb <= pc else c)
+                line[i] = (line[i] + pred) & 0xFF
+        rows.append(line)
+        prev = line
+
+    # Convert to on/off pixels
+    maxval = (1 << depth) - 1
+    pixels = []
+    for line in rows:
+        samples = []
+        if depth < 8:
+            for byte in line:
+                for shift in range(8 - depth, -1, -depth):
+                    samples.append((byte >> shift) & maxval)
+        elif depth == 16:
+            samples = [line[i] for i in range(0, len(line), 2)]
+            maxval = 255
+        else:
+            samples = list(line)
+        row = []
+        for x in range(width):
+            s = samples[x*channels:(x+1)*channels]
+            alpha = maxval
+            if ctype == 3:
+                idx = s[0]
+                r, g, b = palette[idx]
+                lum = (r * 299 + g * 587 + b * 114) / (1000 * 255)
+                if trns is not None and idx < len(trns):
+                    alpha = trns[idx] * maxval // 255
+            elif ctype in (0, 4):
+                lum = s[0] / maxval
+                if ctype == 4:
+                    alpha = s[1]
+            else:
+                lum = (s[0] * 299 + s[1] * 587 + s[2] * 114) / (1000 * maxval)
+                if ctype == 6:
+                    alpha = s[3]
+            row.append(lum < 0.5 and alpha > maxval // 2)
+        pixels.append(row)
+    return width, height, pixels
+
+
+def bank_pack(width, height, pixels):
+    """Pack the pixels in the display memory format"""
+    if height % 8 != 0:
+        raise ValueError('image height must be a multiple of 8')
+    out = bytearray()
+    for bank in range(height // 8):
+        for x in range(width):
+            b = 0
+            for bit in range(8):
+                if pixels[bank*8 + bit][x]:
+                    b |= 1 << bit
+            out.append(b)
+    return bytes(out)
+
+
+def compress(data):
+    """Compress bank packed data (greedy search)"""
+    out = bytearray()
+    literal = bytearray()
+
+    def flush_literal():
+        while literal:
+            n = min(len(literal), MAX_LITERAL)
+            out.append(n - 1)
+            out.extend(literal[:n])
+            del literal[:n]
+
+    pos = 0
+    while pos < len(data):
+        # Repeated byte
+        rep = 1
+        while (pos + rep < len(data) and rep < MAX_REPEAT and
+               data[pos + rep] == data[pos]):
+            rep += 1
+        # Longest copy from previous data
+        copy, dist = 0, 0
+        for d in range(1, min(pos, MAX_DISTANCE) + 1):
+            n = 0
+            while (pos + n < len(data) and n < MAX_COPY and
+                   data[pos + n] == data[pos + n - d]):
+                n += 1
+            if n > copy:
+                copy, dist = n, d
+        if rep >= 2 and rep >= copy:
+            flush_literal()
+            out.append(0x80 | (rep - 2))
+            out.append(data[pos])
+            pos += rep
+        elif copy >= 3:
+            flush_literal()
+            out.append(0xC0 | (copy - 3))
+            out.append(dist - 1)
+            pos += copy
+        else:
+            literal.append(data[pos])
+            pos += 1
+    flush_literal()
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='PNG to LCD asset converter')
+    parser.add_argument('-o', '--output', required=True, help='header to generate')
+    parser.add_argument('assets', nargs='+', help='name=image.png')
+    args = parser.parse_args()
+
+    lines = [
+        '// Generated by pngasset.py - do not edit',
+        '',
+        '#ifndef _LCDASSETS_H',
+        '#define _LCDASSETS_H',
+        '',
+        '#include <stdint.h>',
+        '',
+        '// Compressed image in the display memory format',
+        'typedef struct {',
+        '    uint16_t dx;            // width in pixels',
+        '    uint16_t banks;         // height in 8 pixel banks',
+        '    const uint8_t *data;    // compressed data',
+        '} LCD_ASSET;',
+        '',
+    ]
+    for asset in args.assets:
+        name, fname = asset.split('=', 1)
+        width, height, pixels = read_png(fname)
+        packed = bank_pack(width, height, pixels)
+        comp = compress(packed)
+        lines.append('// %s: %dx%d pixels, %d bytes compressed to %d' %
+                     (name, width, height, len(packed), len(comp)))
+        lines.append('static const uint8_t %s_data[] = {' % name)
+        for i in range(0, len(comp), 12):
+            lines.append('    ' + ' '.join('0x%02X,' % b for b in comp[i:i+12]))
+        lines.append('};')
+        lines.append('static const LCD_ASSET %s = { %d, %d, %s_data };' %
+                     (name, width, height // 8, name))
+        lines.append('')
+    lines.append('#endif')
+
+    with open(args.output, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -3,6 +3,10 @@
  * @author Daniel Quadros
  * @brief Example of using DMA with SPI in the RP2040
  *        to drive a Nokia 5110 display
+ *        The SPI is implemented in the PIO, so commands and data
+ *        can be sent in a single DMA chain started by a timer
+ *        The main screen is triple buffered, so the renderer
+ *        always has a free buffer to draw
  * @version 0.1
  * @date 2022-09-07
  * 
@@ -13,10 +17,21 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <inttypes.h>
 
 #include "pico/stdlib.h"
-#include "hardware/spi.h"
+#include "pico/sync.h"
+#include "hardware/pio.h"
 #include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+
+// Our PIO program:
+#include "lcdspi.pio.h"
+
+// Compressed images for the top and bottom strips
+// (generated from the PNG files in assets by pngasset.py)
+#include "lcdassets.h"
 
 // Display connections
 #define PIN_SCE   20
@@ -37,69 +52,177 @@
 uint8_t lcdInit[] = { 0x21, 0xB0, 0x04, 0x15, 0x20, 0x0C };
 
 // Put display pointer in home position
-uint8_t lcdHome[] =  { 0x40, 0x80 };
+// (as a command run for the PIO: D/C, count-1, commands)
+uint8_t lcdHome[] =  { LCD_CMD, 0, 1, 0x40, 0x80 };
+
+// Header for the data run with the whole screen
+#define LCD_BYTES (LCD_DX*LCD_DY/8)
+uint8_t lcdData[] = { LCD_DAT, (LCD_BYTES-1) >> 8, (LCD_BYTES-1) & 0xFF };
 
 // Each byte in the display memory controls 8 vertical pixels
 // We are going to divide the display in three horizontal strips:
 //   Top      8 pixels high
 //   Main    32 pixels high
 //   Bottom   8 pixels high
+#define N_BUFFERS 3
 uint8_t topScreen[2][LCD_DX];
-uint8_t mainScreen[2][LCD_DX*4];
+uint8_t mainScreen[N_BUFFERS][LCD_DX*4];
 uint8_t bottomScreen[2][LCD_DX];
-int screenDMA = 0;  // main screen programmed in DMA
+
+// Main screen buffers management
+// A buffer can be shown (programmed in the DMA), ready (waiting for
+// the next refresh), being drawn or free
+#define NO_BUFFER -1
+int bufShown = 0;           // main screen programmed in DMA
+int bufReady = NO_BUFFER;   // main screen waiting to be shown
+int bufLast = 0;            // last main screen drawn
+bool newShown = false;      // bufShown was changed in the last refresh
+int readyTop, readyBottom;  // strips to show with the ready buffer
+uint32_t drawStart[N_BUFFERS];  // when drawing of the buffer started
+
+// critical section for accessing the buffers management
+critical_section_t cs_frames;
+
+// Frame statistics
+typedef struct {
+    uint32_t drawn;         // frames drawn by the renderer
+    uint32_t dropped;       // frames replaced before being shown
+    uint32_t presented;     // frames shown in the display
+    uint32_t refreshes;     // screen refreshes
+    uint32_t latencySum;    // draw to glass latency (us)
+    uint32_t latencyMax;
+} FRAME_STATS;
+volatile FRAME_STATS stats;
 
 // SPI Configuration
-#define SPI_ID spi1
+PIO pio = pio0;
+uint sm;
 #define BAUD_RATE 4000000   // 4 MHz
-#define DATA_BITS 8
+
+// Screen refresh rate
+// The DMA timer generates PACE_HZ requests per second,
+// a refresh is started after PACE_HZ/REFRESH_HZ requests
+#define REFRESH_HZ 10
+#define PACE_HZ    4000
+
+// Delay between frames drawn by the renderer
+// With a delay shorter than the refresh period some frames
+// will be dropped
+#define RENDER_DELAY_MS 80
 
 // DMA channel numbers
 int dma_chan_data;
 int dma_chan_ctrl;
+int dma_chan_pace;
+int dma_chan_start;
+int dma_timer;
 
-// Flag to signal end of screen update
-volatile bool screenUpdated = true;
+// CPU time spent in framePresent()
+uint32_t presentTime = 0;
 
-// Control blocks for transfering screen data
+// Control blocks for transfering the commands and screen data
 // We will change the data pointers as needed
 struct {uint32_t len; const char *data;} control_blocks[] = {
+    {sizeof(lcdHome), (const char *) lcdHome},
+    {sizeof(lcdData), (const char *) lcdData},
     {LCD_DX,   NULL},
     {LCD_DX*4, NULL},
     {LCD_DX,   NULL},
     {0, NULL}                     // Null trigger to end chain.
 };
 
+// Address of the first control block, read by the start channel
+const void *chain_start = &control_blocks[0];
+
+// Dummy location for the pacing channel
+uint32_t pace_dummy;
+
 // This rotine will run when the data DMA gets a null trigger
+// The next refresh will only start on the next pacing timeout,
+// so it is safe to change the buffers here
 void dma_irq_handler() {
     // Clear the interrupt request.
     dma_hw->ints0 = 1u << dma_chan_data;
-    // Set flag to indicate end
-    screenUpdated = true;
+    stats.refreshes++;
+
+    // If this was the first refresh with the shown buffer
+    // it is now on glass
+    if (newShown) {
+        uint32_t latency = time_us_32() - drawStart[bufShown];
+        stats.presented++;
+        stats.latencySum += latency;
+        if (latency > stats.latencyMax) {
+            stats.latencyMax = latency;
+        }
+        newShown = false;
+    }
+
+    // Switch to the ready buffer, the previous one will be free
+    if (bufReady != NO_BUFFER) {
+        bufShown = bufReady;
+        bufReady = NO_BUFFER;
+        control_blocks[2].data = topScreen[readyTop];
+        control_blocks[3].data = mainScreen[bufShown];
+        control_blocks[4].data = bottomScreen[readyBottom];
+        newShown = true;
+    }
+}
+
+// Expand a compressed asset into a buffer of dx x banks bytes
+// Returns false (and leaves the buffer untouched) if the asset has another size
+bool decodeAsset(const LCD_ASSET *asset, uint8_t *dst, int dx, int banks) {
+    if ((asset->dx != dx) || (asset->banks != banks)) {
+        return false;
+    }
+    const uint8_t *src = asset->data;
+    uint8_t *end = dst + asset->dx * asset->banks;
+    while (dst < end) {
+        uint8_t token = *src++;
+        int n;
+        if ((token & 0x80) == 0) {
+            // literal bytes
+            n = token + 1;
+            memcpy(dst, src, n);
+            src += n;
+            dst += n;
+        } else if ((token & 0x40) == 0) {
+            // repeated byte
+            n = (token & 0x3F) + 2;
+            memset(dst, *src++, n);
+            dst += n;
+        } else {
+            // copy of previous bytes (can overlap)
+            n = (token & 0x3F) + 3;
+            const uint8_t *from = dst - *src++ - 1;
+            while (n--) {
+                *dst++ = *from++;
+            }
+        }
+    }
+    return true;
 }
 
 // Init screen buffers
 void initStrips() {
-    // Horizontal Lines
-    for (int i = 0; i < LCD_DX; i++) {
-        topScreen[0][i] = 0x55;
-        bottomScreen[0][i] = 0x66;
-    }
-    // Simple Patterns
-    for (int i = 0; i < LCD_DX; i+=2) {
-        topScreen[1][i] = 0x63;
-        topScreen[1][i+1] = 0x63;
-        bottomScreen[1][i] = 0x7F;
-        bottomScreen[1][i+1] = 0x41;
+    // Horizontal Lines and Simple Patterns
+    // The strips are one bank high
+    bool ok = decodeAsset(&top_lines, topScreen[0], LCD_DX, 1) &&
+              decodeAsset(&bottom_lines, bottomScreen[0], LCD_DX, 1) &&
+              decodeAsset(&top_pattern, topScreen[1], LCD_DX, 1) &&
+              decodeAsset(&bottom_pattern, bottomScreen[1], LCD_DX, 1);
+    if (!ok) {
+        printf ("Strip asset is not %dx8 pixels\n", LCD_DX);
     }
     // Main screen is already with zeros
 }
 
 // Init DMA
 void initDMA() {
-    // Get two channels
+    // Get four channels
     dma_chan_data = dma_claim_unused_channel(true);
     dma_chan_ctrl = dma_claim_unused_channel(true);
+    dma_chan_pace = dma_claim_unused_channel(true);
+    dma_chan_start = dma_claim_unused_channel(true);
 
     // Set up control channel
     dma_channel_config c = dma_channel_get_default_config(dma_chan_ctrl);
@@ -119,13 +242,13 @@ void initDMA() {
     // Set up data channel
     c = dma_channel_get_default_config(dma_chan_data);
     channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
-    channel_config_set_dreq(&c, spi_get_dreq(SPI_ID, true));
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
     channel_config_set_chain_to(&c, dma_chan_ctrl);
     channel_config_set_irq_quiet(&c, true);
     dma_channel_configure(
         dma_chan_data,
         &c,
-        &spi_get_hw(SPI_ID)->dr,
+        &pio->txf[sm],
         NULL,   // Initial read address and transfer count 
         0,      // are unimportant
         false   // Don't start yet.
@@ -135,6 +258,42 @@ void initDMA() {
     dma_channel_set_irq0_enabled(dma_chan_data, true);
     irq_set_exclusive_handler(DMA_IRQ_0, dma_irq_handler);
     irq_set_enabled(DMA_IRQ_0, true);
+
+    // Set up start channel
+    // Restarts the control channel and then the pacing channel
+    c = dma_channel_get_default_config(dma_chan_start);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_chain_to(&c, dma_chan_pace);
+    dma_channel_configure(
+        dma_chan_start,
+        &c,
+        &dma_hw->ch[dma_chan_ctrl].al3_read_addr_trig,
+        &chain_start,
+        1,
+        false       // Don't start yet.
+    );
+
+    // Set up pacing channel
+    // Waits for PACE_HZ/REFRESH_HZ timer requests and then
+    // triggers the start channel
+    dma_timer = dma_claim_unused_timer(true);
+    dma_timer_set_fraction(dma_timer, 1, clock_get_hz(clk_sys) / PACE_HZ);
+    c = dma_channel_get_default_config(dma_chan_pace);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, dma_get_timer_dreq(dma_timer));
+    channel_config_set_chain_to(&c, dma_chan_start);
+    dma_channel_configure(
+        dma_chan_pace,
+        &c,
+        &pace_dummy,
+        &pace_dummy,
+        PACE_HZ / REFRESH_HZ,
+        false       // Don't start yet.
+    );
 }
 
 // Init Display
@@ -146,19 +305,11 @@ void displayInit() {
     gpio_init(PIN_RESET);
     gpio_set_dir(PIN_RESET, true);
     gpio_put(PIN_RESET, true);
-    gpio_init(PIN_DC);
-    gpio_set_dir(PIN_DC, true);
-    gpio_put(PIN_DC, true);
-
-    // Set up SPI
-    uint baud = spi_init (SPI_ID, BAUD_RATE);
-    printf ("SPI @ %u Hz\n", baud);
-    spi_set_format (SPI_ID, DATA_BITS, SPI_CPOL_1, SPI_CPHA_1, 
-                    SPI_MSB_FIRST);
 
-    // Set up the SPI pins
-    gpio_set_function(PIN_SCLK, GPIO_FUNC_SPI);
-    gpio_set_function(PIN_SDIN, GPIO_FUNC_SPI);
+    // Set up the PIO SPI, it also controls the D/C pin
+    uint offset = pio_add_program(pio, &lcdspi_program);
+    lcdspi_program_init(pio, sm, offset, PIN_SDIN, PIN_SCLK, PIN_DC,
+                        BAUD_RATE);
 
     // Reset the display controller
     gpio_put(PIN_RESET, false);
@@ -168,46 +319,62 @@ void displayInit() {
     // Initialize the display controller
     // We will not use DMA for this
     gpio_put(PIN_SCE, false);   // leave it selected
-    gpio_put(PIN_DC, false);
-    spi_write_blocking(SPI_ID, lcdInit, sizeof(lcdInit));
-    gpio_put(PIN_DC, true);
+    lcdspi_run_blocking(pio, sm, LCD_CMD, lcdInit, sizeof(lcdInit));
 }
 
-// Refresh the screen
-void displayRefresh(int top, int bottom) {
-    // Make sure previous refresh is finished
-    while (!screenUpdated) {
-        tight_loop_contents();
+// Start the automatic refresh of the screen
+void displayStart() {
+    control_blocks[2].data = topScreen[0];
+    control_blocks[3].data = mainScreen[bufShown];
+    control_blocks[4].data = bottomScreen[0];
+
+    // The first refresh will happen when the pacing channel finishes
+    dma_channel_start(dma_chan_pace);
+}
+
+// Get a free buffer to draw the next frame
+// There are three buffers and at most one is shown and one is ready
+int frameGet() {
+    int buf;
+
+    critical_section_enter_blocking(&cs_frames);
+    for (buf = 0; buf < N_BUFFERS; buf++) {
+        if ((buf != bufShown) && (buf != bufReady)) {
+            break;
+        }
     }
-    screenUpdated = false;
-
-    // Switch buffer
-    screenDMA = 1 - screenDMA;
-
-    // Update data address in control block
-    control_blocks[0].data = topScreen[top];
-    control_blocks[1].data = mainScreen[screenDMA];
-    control_blocks[2].data = bottomScreen[bottom];
-
-    // Position data pointer at start of memory
-    // (also not using DMA for this)
-    gpio_put(PIN_DC, false);
-    spi_write_blocking(SPI_ID, lcdHome, sizeof(lcdHome));
-    gpio_put(PIN_DC, true);
-
-    // Start DMA
-    // Control channel will set the data channel transfers
-    dma_channel_set_read_addr(dma_chan_ctrl, &control_blocks[0], 
-            true);
+    drawStart[buf] = time_us_32();
+    critical_section_exit(&cs_frames);
+    return buf;
 }
 
-// Draw the next frame
-const uint8_t masks[] = { 0xC0, 0xF0, 0x0C, 0x0F };
-void drawFrame() {
-    int s = 1 - screenDMA;
+// Present a frame
+// It will be shown in the next refresh, replacing (dropping)
+// any frame still waiting
+void framePresent(int buf, int top, int bottom) {
+    uint32_t start = time_us_32();
+
+    critical_section_enter_blocking(&cs_frames);
+    if (bufReady != NO_BUFFER) {
+        stats.dropped++;
+    }
+    bufReady = buf;
+    bufLast = buf;
+    readyTop = top;
+    readyBottom = bottom;
+    stats.drawn++;
+    critical_section_exit(&cs_frames);
+
+    presentTime += time_us_32() - start;
+}
 
+// Draw the next frame in buffer s
+const uint8_t masks[] = { 0xC0, 0xF0, 0x0C, 0x0F };
+void drawFrame(int s) {
     // Copy previous screen
-    memcpy(mainScreen[s], mainScreen[screenDMA], 
+    // (the last buffer drawn is either shown or ready, so it
+    // will not be changed while we copy it)
+    memcpy(mainScreen[s], mainScreen[bufLast], 
            sizeof(mainScreen[0]));
 
     // Erase a random rectangle
@@ -231,23 +398,52 @@ void drawFrame() {
 
 // Main Program
 int main() {
+    // Init stdio
+    stdio_init_all();
+
     // Init screen
+    sm = pio_claim_unused_sm(pio, true);
+    critical_section_init(&cs_frames);
     initStrips();
     initDMA();
     displayInit();
-    displayRefresh(0, 0);
+    displayStart();
 
     // Main loop
+    // The renderer runs at its own pace, the display is
+    // refreshed at REFRESH_HZ
     int frameCounter = 0;
     int border = 0;
+    uint32_t lastReport = time_us_32();
     while (1) {
-        sleep_ms(100);
-        drawFrame();
-        displayRefresh(border & 1, (border & 2) >> 1);
+        int buf = frameGet();
+        drawFrame(buf);
+        framePresent(buf, border & 1, (border & 2) >> 1);
         if (++frameCounter == 100) {
             // Change borders from time to time
             frameCounter = 0;
             border = (border + 1) & 3;
+
+            // Show statistics
+            critical_section_enter_blocking(&cs_frames);
+            FRAME_STATS st = stats;
+            memset((void *) &stats, 0, sizeof(stats));
+            critical_section_exit(&cs_frames);
+            uint32_t now = time_us_32();
+            float elapsed = (now - lastReport) / 1000000.0f;
+            lastReport = now;
+            printf ("Drawn: %" PRIu32 " Presented: %" PRIu32 " Dropped: %" PRIu32
+                    " Refreshes: %" PRIu32 "\n",
+                    st.drawn, st.presented, st.dropped, st.refreshes);
+            printf ("FPS: %.1f Latency avg: %" PRIu32 " us max: %" PRIu32 " us\n",
+
+                    st.presented / elapsed,
+                    st.presented ? st.latencySum / st.presented : 0,
+                    st.latencyMax);
+            printf ("CPU time per present: %.2f us\n", presentTime / 100.0f);
+            presentTime = 0;
         }
+        // Simulate the other work done by the program
+        sleep_ms(RENDER_DELAY_MS);
     }
 }
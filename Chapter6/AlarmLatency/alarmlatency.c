@@ -0,0 +1,247 @@
+/**
+ * @file alarmlatency.c
+ * @author Daniel Quadros
+ * @brief Measures the delay between the target time of the hardware
+ *        alarms and the execution of their callbacks
+ *        All four alarms are armed continuously at random targets;
+ *        the delays are collected in histograms under different loads
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+// Number of hardware alarms
+#define N_ALARMS        4
+
+// Samples per alarm in each test
+#define N_SAMPLES       20000
+
+// Random delay for the targets (us)
+#define MIN_DELAY_US    50
+#define MAX_DELAY_US    1050
+
+// Histogram: bins of 2^BIN_SHIFT processor cycles
+#define BIN_SHIFT       5
+#define N_BINS          512
+
+// Interrupt storm: PWM wrap interrupt rate, priority and work
+#define STORM_HZ        100000
+#define STORM_PRIORITY  PICO_DEFAULT_IRQ_PRIORITY
+#define STORM_WORK      100         // loop iterations in the handler
+#define STORM_SLICE     0
+
+// Background loads
+#define LOAD_DMA        1
+#define LOAD_STORM      2
+
+// Statistics for an alarm
+typedef struct {
+    uint32_t hist[N_BINS + 1];      // last bin is overflow
+    volatile uint32_t count;        // polled by run_test
+    uint32_t missed;                // target passed before arming
+    uint32_t min;
+    uint32_t max;
+} ALARM_STATS;
+
+static ALARM_STATS stats[N_ALARMS];
+static uint32_t cyclesPerUs;
+static uint32_t targets[N_ALARMS];
+static uint32_t seed = 12345;
+
+// Simple random generator, safe to use in interrupts
+static inline uint32_t xorshift(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// Arm an alarm for a random time in the future
+static void arm(uint alarm) {
+    while (true) {
+        uint32_t delay = MIN_DELAY_US + (xorshift() % (MAX_DELAY_US - MIN_DELAY_US));
+        uint64_t target = time_us_64() + delay;
+        absolute_time_t t;
+        update_us_since_boot(&t, target);
+        targets[alarm] = (uint32_t) target;
+        if (!hardware_alarm_set_target(alarm, t)) {
+            return;
+        }
+        stats[alarm].missed++;
+    }
+}
+
+// Alarm callback: measure the delay from the target
+// The timer has 1us resolution; to get the delay in cycles we wait for
+// the next change of the timer, counting the cycles with SysTick
+static void alarm_callback(uint alarm) {
+    uint32_t s0 = systick_hw->cvr;
+    uint32_t t0 = timer_hw->timerawl;
+    while (timer_hw->timerawl == t0) {
+    }
+    uint32_t s1 = systick_hw->cvr;
+    uint32_t toEdge = (s0 - s1) & 0xFFFFFF;     // SysTick counts down
+    if (toEdge > cyclesPerUs) {
+        toEdge = cyclesPerUs;
+    }
+    uint32_t delay = (t0 - targets[alarm]) * cyclesPerUs + (cyclesPerUs - toEdge);
+
+    ALARM_STATS *st = &stats[alarm];
+    uint32_t bin = delay >> BIN_SHIFT;
+    st->hist[bin < N_BINS ? bin : N_BINS]++;
+    if (delay < st->min) {
+        st->min = delay;
+    }
+    if (delay > st->max) {
+        st->max = delay;
+    }
+    if (++st->count < N_SAMPLES) {
+        arm(alarm);
+    }
+}
+
+// Interrupt storm handler
+static void storm_handler(void) {
+    pwm_clear_irq(STORM_SLICE);
+    for (volatile int i = 0; i < STORM_WORK; i++) {
+    }
+}
+
+// DMA load: a channel writing continuously to RAM
+static int dmaChan = -1;
+static uint32_t dmaSrc;
+static uint32_t dmaDst[1024] __attribute__((aligned(4096)));
+
+static void start_loads(int loads) {
+    if (loads & LOAD_DMA) {
+        dmaChan = dma_claim_unused_channel(true);
+        dma_channel_config c = dma_channel_get_default_config(dmaChan);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_ring(&c, true, 12);      // 4096 bytes
+        channel_config_set_high_priority(&c, true);
+        dma_channel_configure(dmaChan, &c, dmaDst, &dmaSrc, 0xFFFFFFFF, true);
+    }
+    if (loads & LOAD_STORM) {
+        pwm_config c = pwm_get_default_config();
+        pwm_config_set_wrap(&c, (clock_get_hz(clk_sys) / STORM_HZ) - 1);
+        pwm_init(STORM_SLICE, &c, false);
+        pwm_clear_irq(STORM_SLICE);
+        pwm_set_irq_enabled(STORM_SLICE, true);
+        irq_set_exclusive_handler(PWM_IRQ_WRAP, storm_handler);
+        irq_set_priority(PWM_IRQ_WRAP, STORM_PRIORITY);
+        irq_set_enabled(PWM_IRQ_WRAP, true);
+        pwm_set_enabled(STORM_SLICE, true);
+    }
+}
+
+static void stop_loads(int loads) {
+    if (loads & LOAD_DMA) {
+        dma_channel_abort(dmaChan);
+        dma_channel_unclaim(dmaChan);
+    }
+    if (loads & LOAD_STORM) {
+        pwm_set_enabled(STORM_SLICE, false);
+        irq_set_enabled(PWM_IRQ_WRAP, false);
+        pwm_set_irq_enabled(STORM_SLICE, false);
+        irq_remove_handler(PWM_IRQ_WRAP, storm_handler);
+    }
+}
+
+// Value (in cycles) below which there are 'per1000' thousandths
+// of the samples, taken from the histogram (upper limit of the bin)
+static uint32_t percentile(ALARM_STATS *st, uint32_t per1000) {
+    uint32_t limit = (uint32_t) (((uint64_t) st->count * per1000 + 999) / 1000);
+    uint32_t sum = 0;
+    for (int i = 0; i <= N_BINS; i++) {
+        sum += st->hist[i];
+        if (sum >= limit) {
+            return (i == N_BINS) ? st->max : ((i + 1) << BIN_SHIFT) - 1;
+        }
+    }
+    return st->max;
+}
+
+// Convert cycles to ns
+static inline uint32_t to_ns(uint32_t cycles) {
+    return (uint32_t) (((uint64_t) cycles * 1000) / cyclesPerUs);
+}
+
+// Run a test and show the results
+static void run_test(const char *name, int loads) {
+    memset(stats, 0, sizeof(stats));
+    for (int i = 0; i < N_ALARMS; i++) {
+        stats[i].min = UINT32_MAX;
+    }
+
+    start_loads(loads);
+    for (uint i = 0; i < N_ALARMS; i++) {
+        arm(i);
+    }
+    bool done = false;
+    while (!done) {
+        done = true;
+        for (int i = 0; i < N_ALARMS; i++) {
+            if (stats[i].count < N_SAMPLES) {
+                done = false;
+            }
+        }
+    }
+    stop_loads(loads);
+
+    printf("\n%s (delays in ns)\n", name);
+    printf("alarm    min    p50    p90    p99  p99.9    max  missed\n");
+    for (int i = 0; i < N_ALARMS; i++) {
+        ALARM_STATS *st = &stats[i];
+        printf("%5d %6" PRIu32 " %6" PRIu32 " %6" PRIu32 " %6" PRIu32
+               " %6" PRIu32 " %6" PRIu32 " %7" PRIu32 "\n", i,
+
+               to_ns(st->min), to_ns(percentile(st, 500)),
+               to_ns(percentile(st, 900)), to_ns(percentile(st, 990)),
+               to_ns(percentile(st, 999)), to_ns(st->max), st->missed);
+    }
+}
+
+// Main program
+int main() {
+    stdio_init_all();
+
+    // Start SysTick counting processor cycles
+    systick_hw->rvr = 0xFFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 5;    // processor clock, enabled
+    cyclesPerUs = clock_get_hz(clk_sys) / 1000000;
+
+    // Claim all hardware alarms
+    for (uint i = 0; i < N_ALARMS; i++) {
+        hardware_alarm_claim(i);
+        hardware_alarm_set_callback(i, alarm_callback);
+    }
+
+    while (true) {
+        printf("\nAlarm Latency Benchmark\n");
+        printf("%d samples per alarm, clk_sys = %" PRIu32 "MHz\n"
+, N_SAMPLES, cyclesPerUs);
+        run_test("No load", 0);
+        run_test("DMA load", LOAD_DMA);
+        run_test("Interrupt storm", LOAD_STORM);
+        run_test("DMA and interrupt storm", LOAD_DMA | LOAD_STORM);
+        sleep_ms(10000);
+    }
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file clockmon.c
+ * @author Daniel Quadros
+ * @brief Background clock monitor using the frequency counter
+ *        The sources are measured one at a time; a repeating timer
+ *        checks the DONE status, collects the result and starts
+ *        the next measure, so no one waits for the counter.
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "hardware/structs/clocks.h"
+#include "clockmon.h"
+
+// Measure interval (2^10 reference cycles ~ 1ms for 1kHz resolution)
+#define FC_INTERVAL 10
+
+// Monitored clocks
+typedef struct {
+    uint src;
+    uint32_t tolerance;
+    CLOCKMON_STATS stats;
+} CLOCKMON;
+
+static CLOCKMON clocks[CLOCKMON_MAX_CLOCKS];
+static int nClocks = 0;
+static int current = 0;
+static clockmon_callback_t callback = NULL;
+static struct repeating_timer timer;
+static bool running = false;
+
+// Reset statistics of a clock
+static void reset_stats(CLOCKMON *clk, uint32_t expected_khz) {
+    clk->stats.expected = expected_khz;
+    clk->stats.last = 0;
+    clk->stats.min = UINT32_MAX;
+    clk->stats.max = 0;
+    clk->stats.drift = 0;
+    clk->stats.count = 0;
+    clk->stats.outOfTol = 0;
+    clk->stats.inTolerance = true;
+}
+
+// Start measuring a clock
+static void fc_start(uint src) {
+    clocks_hw->fc0_ref_khz = clock_get_hz(clk_ref) / 1000;
+    clocks_hw->fc0_interval = FC_INTERVAL;
+    clocks_hw->fc0_min_khz = 0;
+    clocks_hw->fc0_max_khz = 0xFFFFFFFF;
+    clocks_hw->fc0_src = src;   // this starts the measure
+}
+
+// Update the statistics of a clock with a new measure
+static void update_stats(int i, uint32_t khz) {
+    CLOCKMON *clk = &clocks[i];
+    if (clk->stats.expected == 0) {
+        clk->stats.expected = khz;
+    }
+    clk->stats.last = khz;
+    if (khz < clk->stats.min) {
+        clk->stats.min = khz;
+    }
+    if (khz > clk->stats.max) {
+        clk->stats.max = khz;
+    }
+    clk->stats.drift = (int32_t) khz - (int32_t) clk->stats.expected;
+    clk->stats.count++;
+    bool inTol = (uint32_t) abs(clk->stats.drift) <= clk->tolerance;
+    if (!inTol) {
+        clk->stats.outOfTol++;
+    }
+    if (inTol != clk->stats.inTolerance) {
+        clk->stats.inTolerance = inTol;
+        if (callback != NULL) {
+            callback(i, khz, inTol);
+        }
+    }
+}
+
+// Timer callback: collects a result and starts the next measure
+static bool clockmon_tick(struct repeating_timer *t) {
+    if (clocks_hw->fc0_status & CLOCKS_FC0_STATUS_DONE_BITS) {
+        uint32_t khz = clocks_hw->fc0_result >> CLOCKS_FC0_RESULT_KHZ_LSB;
+        update_stats(current, khz);
+        current = (current + 1) % nClocks;
+        fc_start(clocks[current].src);
+    }
+    return true;
+}
+
+// Add a clock to monitor
+int clockmon_add(uint src, uint32_t expected_khz, uint32_t tolerance_khz) {
+    if (running || (nClocks == CLOCKMON_MAX_CLOCKS)) {
+        return -1;
+    }
+    clocks[nClocks].src = src;
+    clocks[nClocks].tolerance = tolerance_khz;
+    reset_stats(&clocks[nClocks], expected_khz);
+    return nClocks++;
+}
+
+// Change the expected frequency of a clock
+void clockmon_set_expected(int clk, uint32_t expected_khz) {
+    uint32_t save = save_and_disable_interrupts();
+    reset_stats(&clocks[clk], expected_khz);
+    restore_interrupts(save);
+}
+
+// Define the routine to be called on tolerance changes
+void clockmon_set_callback(clockmon_callback_t cb) {
+    callback = cb;
+}
+
+// Start monitoring
+bool clockmon_start(uint period_ms) {
+    if (running || (nClocks == 0)) {
+        return false;
+    }
+    // Wait for any measure in progress
+    while (clocks_hw->fc0_status & CLOCKS_FC0_STATUS_RUNNING_BITS) {
+        tight_loop_contents();
+    }
+    current = 0;
+    fc_start(clocks[0].src);
+    running = add_repeating_timer_ms(period_ms, clockmon_tick, NULL, &timer);
+    return running;
+}
+
+// Stop monitoring
+void clockmon_stop(void) {
+    if (running) {
+        cancel_repeating_timer(&timer);
+        running = false;
+    }
+}
+
+// Get a copy of the statistics of a clock
+void clockmon_get_stats(int clk, CLOCKMON_STATS *stats) {
+    uint32_t save = save_and_disable_interrupts();
+    *stats = clocks[clk].stats;
+    restore_interrupts(save);
+}
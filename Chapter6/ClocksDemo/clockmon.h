@@ -0,0 +1,57 @@
+/**
+ * @file clockmon.h
+ * @author Daniel Quadros
+ * @brief Background clock monitor using the frequency counter
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _CLOCKMON_H
+#define _CLOCKMON_H
+
+#include "pico/stdlib.h"
+
+// Maximum number of clocks monitored
+#define CLOCKMON_MAX_CLOCKS 10
+
+// Statistics for a clock (frequencies in kHz)
+typedef struct {
+    uint32_t expected;              // nominal frequency
+    uint32_t last;                  // last measure
+    uint32_t min;                   // smallest measure
+    uint32_t max;                   // largest measure
+    int32_t drift;                  // last - expected
+    uint32_t count;                 // number of measures
+    uint32_t outOfTol;              // number of measures out of tolerance
+    bool inTolerance;               // current state
+} CLOCKMON_STATS;
+
+// Routine called (in interrupt context) when a clock leaves
+// or returns to tolerance
+typedef void (*clockmon_callback_t)(int clk, uint32_t khz, bool inTolerance);
+
+// Add a clock to monitor (src is one of CLOCKS_FC0_SRC_VALUE_xxx)
+// If expected is zero, the first measure is used as expected frequency
+// Returns the clock index, or -1 if there is no room
+int clockmon_add(uint src, uint32_t expected_khz, uint32_t tolerance_khz);
+
+// Change the expected frequency of a clock (resets its statistics)
+void clockmon_set_expected(int clk, uint32_t expected_khz);
+
+// Define the routine to be called on tolerance changes
+void clockmon_set_callback(clockmon_callback_t cb);
+
+// Start monitoring, checking for a result every period_ms
+// Do not use frequency_count_khz() while the monitor is running
+bool clockmon_start(uint period_ms);
+
+// Stop monitoring
+void clockmon_stop(void);
+
+// Get a copy of the statistics of a clock
+void clockmon_get_stats(int clk, CLOCKMON_STATS *stats);
+
+#endif
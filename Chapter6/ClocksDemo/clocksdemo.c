@@ -3,6 +3,8 @@
  * @author Daniel Quadros
  * @brief Example of using the Clocks API
  *        Based on the hello_48MHz and  hello_gpout SDK examples
+ *        Also changes the system PLL at runtime, using pllsolver,
+ *        and monitors the clocks in background, using clockmon
  * @version 0.1
  * @date 2022-07-14
  * 
@@ -11,11 +13,34 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
 #include "pico/stdlib.h"
 #include "hardware/pll.h"
 #include "hardware/clocks.h"
+#include "hardware/vreg.h"
+#include "hardware/sync.h"
 #include "hardware/structs/pll.h"
 #include "hardware/structs/clocks.h"
+#include "hardware/structs/ssi.h"
+#include "pllsolver.h"
+#include "clockmon.h"
+
+// Clock profiles
+typedef struct {
+    const char *name;
+    uint32_t khz;
+} CLOCK_PROFILE;
+
+static const CLOCK_PROFILE profiles[] = {
+    { "Low power", 24000 },
+    { "Nominal", 125000 },
+    { "Overclock", 250000 }
+};
+#define N_PROFILES (sizeof(profiles)/sizeof(profiles[0]))
+
+// Measured clk_sys must be within this tolerance (in kHz)
+#define FREQ_TOLERANCE_KHZ  500
 
 // Use the frequency counter to measure the various clocks
 void measure_freqs(void) {
@@ -40,6 +65,128 @@ void measure_freqs(void) {
     stdio_flush();  // make sure output is sent before continuing
 }
 
+// Clocks for the background monitor
+// (expected 0 means use the first measure)
+typedef struct {
+    const char *name;
+    uint src;
+    uint32_t expected_khz;
+    uint32_t tolerance_khz;
+} MONITORED_CLOCK;
+
+static MONITORED_CLOCK monitored[] = {
+    { "pll_sys ", CLOCKS_FC0_SRC_VALUE_PLL_SYS_CLKSRC_PRIMARY, 0, 500 },
+    { "pll_usb ", CLOCKS_FC0_SRC_VALUE_PLL_USB_CLKSRC_PRIMARY, 48000, 100 },
+    { "xosc    ", CLOCKS_FC0_SRC_VALUE_XOSC_CLKSRC, 12000, 50 },
+    { "rosc    ", CLOCKS_FC0_SRC_VALUE_ROSC_CLKSRC, 0, 300 },
+    { "clk_sys ", CLOCKS_FC0_SRC_VALUE_CLK_SYS, 0, 500 },
+    { "clk_peri", CLOCKS_FC0_SRC_VALUE_CLK_PERI, 0, 500 },
+    { "clk_usb ", CLOCKS_FC0_SRC_VALUE_CLK_USB, 48000, 100 },
+    { "clk_adc ", CLOCKS_FC0_SRC_VALUE_CLK_ADC, 48000, 100 }
+};
+#define N_MONITORED (sizeof(monitored)/sizeof(monitored[0]))
+
+// Tolerance events, recorded in the monitor callback (interrupt context)
+static volatile uint32_t tolEvents = 0;
+static volatile int tolClock;
+static volatile uint32_t tolKhz;
+static volatile bool tolIn;
+
+void monitor_callback(int clk, uint32_t khz, bool inTolerance) {
+    tolClock = clk;
+    tolKhz = khz;
+    tolIn = inTolerance;
+    tolEvents++;
+}
+
+// Print the statistics of the monitored clocks
+void print_monitor(void) {
+    printf("\nclock     expected    last     min     max  drift  count  out\n");
+    for (uint i = 0; i < N_MONITORED; i++) {
+        CLOCKMON_STATS st;
+        clockmon_get_stats(i, &st);
+        printf("%s %8" PRIu32 " %7" PRIu32 " %7" PRIu32 " %7" PRIu32 " %6" PRId32
+               " %6" PRIu32 " %4" PRIu32 "\n", monitored[i].name,
+               st.expected, st.last, st.min, st.max, st.drift,
+               st.count, st.outOfTol);
+    }
+    stdio_flush();
+}
+
+// Change the flash clock divider
+// This runs from RAM with interrupts disabled, as the flash
+// is not accessible while the SSI is disabled
+static void __no_inline_not_in_flash_func(set_flash_div)(uint32_t div) {
+    uint32_t save = save_and_disable_interrupts();
+    while (ssi_hw->sr & SSI_SR_BUSY_BITS) {
+    }
+    ssi_hw->ssienr = 0;
+    ssi_hw->baudr = div;
+    ssi_hw->ssienr = 1;
+    restore_interrupts(save);
+}
+
+// Convert a voltage in mV to the vreg setting
+static enum vreg_voltage vreg_from_mv(uint32_t mv) {
+    return (enum vreg_voltage) (VREG_VOLTAGE_0_85 + (mv - 850) / 50);
+}
+
+// Change clk_sys and clk_peri to the frequency of the profile
+// Returns false if the frequency is not possible
+bool set_profile(const CLOCK_PROFILE *profile) {
+    PLL_CONFIG cfg;
+    if (!pll_solve(XOSC_MHZ * MHZ, profile->khz * KHZ, &cfg)) {
+        return false;
+    }
+    printf("REFDIV=%" PRIu32 " FBDIV=%" PRIu32 " POSTDIV1=%" PRIu32 " POSTDIV2=%" PRIu32
+           " VCO=%" PRIu32 "MHz\n",
+           cfg.refdiv, cfg.fbdiv, cfg.postdiv1, cfg.postdiv2, cfg.vco_hz / MHZ);
+    stdio_flush();
+
+    uint32_t old_hz = clock_get_hz(clk_sys);
+    uint32_t flash_div = pll_flash_div(cfg.out_hz);
+    uint32_t mv = pll_voltage_mv(cfg.out_hz);
+
+    // Raise the voltage and slow down the flash before speeding up
+    if (cfg.out_hz > old_hz) {
+        vreg_set_voltage(vreg_from_mv(mv));
+        sleep_ms(10);
+        if (flash_div > ssi_hw->baudr) {
+            set_flash_div(flash_div);
+        }
+    }
+
+    // Run from the USB PLL while the system PLL is changed
+    clock_configure(clk_sys,
+                    CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                    CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB,
+                    48 * MHZ,
+                    48 * MHZ);
+    pll_init(pll_sys, cfg.refdiv, cfg.vco_hz, cfg.postdiv1, cfg.postdiv2);
+    clock_configure(clk_sys,
+                    CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                    CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS,
+                    cfg.out_hz,
+                    cfg.out_hz);
+    clock_configure(clk_peri,
+                    0,
+                    CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS,
+                    cfg.out_hz,
+                    cfg.out_hz);
+
+    // Lower the voltage and speed up the flash after slowing down
+    if (cfg.out_hz <= old_hz) {
+        if (flash_div < ssi_hw->baudr) {
+            set_flash_div(flash_div);
+        }
+        vreg_set_voltage(vreg_from_mv(mv));
+    }
+
+    // In case stdio is through UART
+    stdio_init_all();
+    return true;
+}
+
 int main() {
     stdio_init_all();
     #ifdef LIB_PICO_STDIO_USB
@@ -79,8 +226,51 @@ int main() {
     printf("\nNow operating at 48MHz.\n");
     measure_freqs();
 
-    // That's all
+    // Try the profiles, checking the resulting frequency
+    for (uint i = 0; i < N_PROFILES; i++) {
+        printf("\n%s profile: %" PRIu32 "kHz\n", profiles[i].name, profiles[i].khz);
+        if (!set_profile(&profiles[i])) {
+            printf("Not possible!\n");
+            continue;
+        }
+        measure_freqs();
+        uint f_clk_sys = frequency_count_khz(CLOCKS_FC0_SRC_VALUE_CLK_SYS);
+        int error = (int) f_clk_sys - (int) profiles[i].khz;
+        printf("Flash div=%" PRIu32 ", %s\n", ssi_hw->baudr,
+
+               (abs(error) <= FREQ_TOLERANCE_KHZ) ? "OK" : "FAIL");
+        sleep_ms(2000);
+    }
+
+    // Monitor the clocks in background
+    // clk_sys and clk_peri are expected at the last profile frequency
+    for (uint i = 0; i < N_MONITORED; i++) {
+        if (monitored[i].src == CLOCKS_FC0_SRC_VALUE_CLK_SYS) {
+            monitored[i].expected_khz = clock_get_hz(clk_sys) / KHZ;
+        } else if (monitored[i].src == CLOCKS_FC0_SRC_VALUE_CLK_PERI) {
+            monitored[i].expected_khz = clock_get_hz(clk_peri) / KHZ;
+        }
+        clockmon_add(monitored[i].src, monitored[i].expected_khz,
+                     monitored[i].tolerance_khz);
+    }
+    clockmon_set_callback(monitor_callback);
+    clockmon_start(5);
+    printf("\nMonitoring clocks in background\n");
+
+    // The main loop is free to do other things
+    uint32_t lastEvents = 0;
+    absolute_time_t next = make_timeout_time_ms(5000);
     while (true) {
+        if (tolEvents != lastEvents) {
+            lastEvents = tolEvents;
+            printf("%s %s tolerance (%" PRIu32 "kHz)\n", monitored[tolClock].name,
+
+                   tolIn ? "back in" : "out of", tolKhz);
+        }
+        if (time_reached(next)) {
+            print_monitor();
+            next = make_timeout_time_ms(5000);
+        }
         sleep_ms(100);
     }
 
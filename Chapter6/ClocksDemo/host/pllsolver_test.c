@@ -0,0 +1,152 @@
+/**
+ * @file pllsolver_test.c
+ * @author Daniel Quadros
+ * @brief Test of pllsolver.c in the host
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ * For a range of frequencies, checks that the configuration returned
+ * is within the PLL limits, that its output is the one calculated from
+ * the dividers and that no other configuration gets closer to the target
+ * (found by trying all of them).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pllsolver.h"
+
+// Crystal in the Pico board
+#define REF_HZ      12000000u
+
+// Frequencies tested
+#define FIRST_HZ    10000000u
+#define LAST_HZ     300000000u
+#define STEP_HZ     100000u
+
+static int errors;
+
+// Report an error
+static void fail(uint32_t target, const char *msg, const PLL_CONFIG *cfg) {
+    printf("%u Hz: %s (refdiv %u fbdiv %u postdiv %u/%u vco %u out %u)\n",
+           target, msg, cfg->refdiv, cfg->fbdiv, cfg->postdiv1, cfg->postdiv2,
+           cfg->vco_hz, cfg->out_hz);
+    errors++;
+}
+
+static uint32_t distance(uint32_t a, uint32_t b) {
+    return (a > b) ? a - b : b - a;
+}
+
+// Smallest error possible for a target, trying all configurations
+// Returns false if there is no valid configuration
+static bool best_error(uint32_t ref_hz, uint32_t target_hz, uint32_t *error) {
+    bool found = false;
+    for (uint32_t refdiv = PLL_REFDIV_MIN; refdiv <= PLL_REFDIV_MAX; refdiv++) {
+        if ((ref_hz / refdiv) < PLL_PFD_MIN_HZ) {
+            break;
+        }
+        for (uint32_t fbdiv = PLL_FBDIV_MIN; fbdiv <= PLL_FBDIV_MAX; fbdiv++) {
+            uint64_t vco = ((uint64_t) ref_hz * fbdiv) / refdiv;
+            if ((vco < PLL_VCO_MIN_HZ) || (vco > PLL_VCO_MAX_HZ)) {
+                continue;
+            }
+            for (uint32_t div = 1; div <= PLL_POSTDIV_MAX*PLL_POSTDIV_MAX; div++) {
+                // div must be the product of two postdivs
+                bool ok = false;
+                for (uint32_t pd1 = PLL_POSTDIV_MIN; pd1 <= PLL_POSTDIV_MAX; pd1++) {
+                    if (((div % pd1) == 0) && ((div / pd1) <= PLL_POSTDIV_MAX)) {
+                        ok = true;
+                    }
+                }
+                if (!ok) {
+                    continue;
+                }
+                uint32_t err = distance((uint32_t) ((vco + div/2) / div), target_hz);
+                if (!found || (err < *error)) {
+                    *error = err;
+                    found = true;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+// Check the configuration for a target
+static void check(uint32_t target) {
+    PLL_CONFIG cfg;
+    uint32_t bestErr = 0;
+    bool possible = best_error(REF_HZ, target, &bestErr);
+    if (!pll_solve(REF_HZ, target, &cfg)) {
+        if (possible) {
+            printf("%u Hz: no configuration found\n", target);
+            errors++;
+        }
+        return;
+    }
+    if (!possible) {
+        fail(target, "returned an impossible configuration", &cfg);
+        return;
+    }
+    if ((cfg.refdiv < PLL_REFDIV_MIN) || (cfg.refdiv > PLL_REFDIV_MAX) ||
+        ((REF_HZ / cfg.refdiv) < PLL_PFD_MIN_HZ)) {
+        fail(target, "REFDIV out of range", &cfg);
+    }
+    if ((cfg.fbdiv < PLL_FBDIV_MIN) || (cfg.fbdiv > PLL_FBDIV_MAX)) {
+        fail(target, "FBDIV out of range", &cfg);
+    }
+    if ((cfg.postdiv1 < PLL_POSTDIV_MIN) || (cfg.postdiv1 > PLL_POSTDIV_MAX) ||
+        (cfg.postdiv2 < PLL_POSTDIV_MIN) || (cfg.postdiv2 > cfg.postdiv1)) {
+        fail(target, "POSTDIV out of range", &cfg);
+    }
+    uint64_t vco = ((uint64_t) REF_HZ * cfg.fbdiv) / cfg.refdiv;
+    if ((vco != cfg.vco_hz) || (vco < PLL_VCO_MIN_HZ) || (vco > PLL_VCO_MAX_HZ)) {
+        fail(target, "wrong VCO", &cfg);
+    }
+    uint32_t div = cfg.postdiv1 * cfg.postdiv2;
+    if (cfg.out_hz != (uint32_t) ((vco + div/2) / div)) {
+        fail(target, "wrong output", &cfg);
+    }
+    if (distance(cfg.out_hz, target) != bestErr) {
+        fail(target, "not the closest output", &cfg);
+    }
+}
+
+int main(void) {
+    PLL_CONFIG cfg;
+
+    // The SDK configurations
+    if (!pll_solve(REF_HZ, 125000000u, &cfg) || (cfg.out_hz != 125000000u)) {
+        fail(125000000u, "125MHz not exact", &cfg);
+    }
+    if (!pll_solve(REF_HZ, 48000000u, &cfg) || (cfg.out_hz != 48000000u)) {
+        fail(48000000u, "48MHz not exact", &cfg);
+    }
+
+    // Range of frequencies
+    uint32_t n = 0;
+    for (uint32_t target = FIRST_HZ; target <= LAST_HZ; target += STEP_HZ) {
+        check(target);
+        n++;
+    }
+
+    // Voltage and flash divider
+    for (uint32_t sys = 1000000u; sys <= LAST_HZ; sys += 1000000u) {
+        uint32_t div = pll_flash_div(sys);
+        if ((div < 2) || (div & 1) || ((sys / div) > FLASH_MAX_HZ) ||
+            ((div > 2) && ((sys / (div - 2)) <= FLASH_MAX_HZ))) {
+            printf("%u Hz: wrong flash divider %u\n", sys, div);
+            errors++;
+        }
+        if ((sys > 133000000u) && (pll_voltage_mv(sys) <= 1100)) {
+            printf("%u Hz: voltage not raised\n", sys);
+            errors++;
+        }
+    }
+
+    printf("%u frequencies tested, %d errors\n", n, errors);
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file pllsolver.c
+ * @author Daniel Quadros
+ * @brief Find the PLL configuration for a given frequency
+ *        This code does not access the hardware, so it can
+ *        also be compiled and tested in a PC
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include "pllsolver.h"
+
+// Try a FBDIV, updates best configuration if this is better
+static void try_fbdiv(uint32_t ref_hz, uint32_t target_hz, uint32_t refdiv,
+                      uint32_t fbdiv, uint32_t pd1, uint32_t pd2,
+                      PLL_CONFIG *best, uint32_t *bestError, bool *found) {
+    if ((fbdiv < PLL_FBDIV_MIN) || (fbdiv > PLL_FBDIV_MAX)) {
+        return;
+    }
+    uint64_t vco = ((uint64_t) ref_hz * fbdiv) / refdiv;
+    if ((vco < PLL_VCO_MIN_HZ) || (vco > PLL_VCO_MAX_HZ)) {
+        return;
+    }
+    uint32_t div = pd1 * pd2;
+    uint32_t out = (uint32_t) ((vco + div/2) / div);
+    uint32_t error = (out > target_hz) ? out - target_hz : target_hz - out;
+    if (*found) {
+        // Keep the current one if it is better or equivalent
+        if (error > *bestError) {
+            return;
+        }
+        if (error == *bestError) {
+            if (refdiv > best->refdiv) {
+                return;
+            }
+            if ((refdiv == best->refdiv) && (vco <= best->vco_hz)) {
+                return;
+            }
+        }
+    }
+    best->refdiv = refdiv;
+    best->fbdiv = fbdiv;
+    best->postdiv1 = pd1;
+    best->postdiv2 = pd2;
+    best->vco_hz = (uint32_t) vco;
+    best->out_hz = out;
+    *bestError = error;
+    *found = true;
+}
+
+// Find the configuration with output closest to target_hz
+bool pll_solve(uint32_t ref_hz, uint32_t target_hz, PLL_CONFIG *cfg) {
+    bool found = false;
+    uint32_t bestError = 0;
+
+    for (uint32_t refdiv = PLL_REFDIV_MIN; refdiv <= PLL_REFDIV_MAX; refdiv++) {
+        if ((ref_hz / refdiv) < PLL_PFD_MIN_HZ) {
+            break;
+        }
+        // FBDIV range that keeps the VCO in range
+        uint32_t fbdivMin = (uint32_t) (((uint64_t) PLL_VCO_MIN_HZ * refdiv + ref_hz - 1) / ref_hz);
+        uint32_t fbdivMax = (uint32_t) (((uint64_t) PLL_VCO_MAX_HZ * refdiv) / ref_hz);
+        // POSTDIV1 >= POSTDIV2 uses less power
+        for (uint32_t pd1 = PLL_POSTDIV_MIN; pd1 <= PLL_POSTDIV_MAX; pd1++) {
+            for (uint32_t pd2 = PLL_POSTDIV_MIN; pd2 <= pd1; pd2++) {
+                // Best FBDIV is next to target * refdiv * pd1 * pd2 / ref
+                uint64_t num = (uint64_t) target_hz * refdiv * pd1 * pd2;
+                uint32_t fbdiv = (uint32_t) (num / ref_hz);
+                // Out of the VCO range, the closest is at the limit
+                if (fbdiv < fbdivMin) {
+                    fbdiv = fbdivMin;
+                } else if (fbdiv > fbdivMax) {
+                    fbdiv = fbdivMax;
+                }
+                try_fbdiv(ref_hz, target_hz, refdiv, fbdiv, pd1, pd2,
+                          cfg, &bestError, &found);
+                try_fbdiv(ref_hz, target_hz, refdiv, fbdiv+1, pd1, pd2,
+                          cfg, &bestError, &found);
+            }
+        }
+    }
+    return found;
+}
+
+// Core voltage (in mV) recommended for a clk_sys frequency
+uint32_t pll_voltage_mv(uint32_t sys_hz) {
+    if (sys_hz <= 50000000u) {
+        return 1000;
+    } else if (sys_hz <= 133000000u) {
+        return 1100;    // default voltage
+    } else if (sys_hz <= 200000000u) {
+        return 1150;
+    } else {
+        return 1200;
+    }
+}
+
+// Flash clock divider (even, at least 2) for a clk_sys frequency
+uint32_t pll_flash_div(uint32_t sys_hz) {
+    uint32_t div = 2;
+    while ((sys_hz / div) > FLASH_MAX_HZ) {
+        div += 2;
+    }
+    return div;
+}
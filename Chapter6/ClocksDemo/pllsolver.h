@@ -0,0 +1,56 @@
+/**
+ * @file pllsolver.h
+ * @author Daniel Quadros
+ * @brief Find the PLL configuration for a given frequency
+ *        This code does not access the hardware, so it can
+ *        also be compiled and tested in a PC
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _PLLSOLVER_H
+#define _PLLSOLVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// PLL limits (RP2040 datasheet)
+#define PLL_REFDIV_MIN      1
+#define PLL_REFDIV_MAX      63
+#define PLL_FBDIV_MIN       16
+#define PLL_FBDIV_MAX       320
+#define PLL_POSTDIV_MIN     1
+#define PLL_POSTDIV_MAX     7
+#define PLL_PFD_MIN_HZ      5000000u
+#define PLL_VCO_MIN_HZ      750000000u
+#define PLL_VCO_MAX_HZ      1600000000u
+
+// Maximum flash clock (the SSI divides clk_sys by an even number)
+#define FLASH_MAX_HZ        133000000u
+
+// A PLL configuration
+typedef struct {
+    uint32_t refdiv;
+    uint32_t fbdiv;
+    uint32_t postdiv1;
+    uint32_t postdiv2;
+    uint32_t vco_hz;
+    uint32_t out_hz;        // output frequency (rounded)
+} PLL_CONFIG;
+
+// Find the configuration with output closest to target_hz
+// Among the configurations with the same output, the one with
+// the smaller REFDIV and then with the higher VCO is selected
+// (less jitter). Returns false if no configuration is possible.
+bool pll_solve(uint32_t ref_hz, uint32_t target_hz, PLL_CONFIG *cfg);
+
+// Core voltage (in mV) recommended for a clk_sys frequency
+uint32_t pll_voltage_mv(uint32_t sys_hz);
+
+// Flash clock divider (even, at least 2) for a clk_sys frequency
+uint32_t pll_flash_div(uint32_t sys_hz);
+
+#endif
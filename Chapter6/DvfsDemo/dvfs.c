@@ -0,0 +1,193 @@
+/**
+ * @file dvfs.c
+ * @author Daniel Quadros
+ * @brief Dynamic frequency and voltage scaling governor
+ *        The load is the fraction of time not spent in dvfs_idle().
+ *        When the clock changes, the listeners are called with the
+ *        interrupts disabled, so no interrupt routine will run with
+ *        dividers calculated for the old clock.
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "hardware/vreg.h"
+
+#include "dvfs.h"
+
+// Governor parameters
+#define DVFS_PERIOD_US  100000  // load evaluation period
+#define DVFS_UP_LOAD    80      // go up if load is above this (%)
+#define DVFS_DOWN_LOAD  30      // go down if load is below this (%)
+
+// Time for the regulator to settle after raising the voltage
+#define VREG_SETTLE_US  1000
+
+// Operating points
+static const DVFS_OP *opTable;
+static int nOpTable;
+static int curOp;
+static uint64_t opStart;        // when the current op was selected
+
+// Listeners
+static struct {
+    dvfs_listener_t fn;
+    void *ctx;
+} listeners[DVFS_MAX_LISTENERS];
+static int nListeners = 0;
+
+// Load evaluation
+static uint64_t periodStart;
+static uint64_t periodIdle;
+
+// Statistics
+static DVFS_STATS stats[DVFS_MAX_OPS];
+
+// Convert the voltage selection to volts
+static float vreg_volts(enum vreg_voltage v) {
+    return 0.85f + ((int) v - (int) VREG_VOLTAGE_0_85) * 0.05f;
+}
+
+// Init the governor
+bool dvfs_init(const DVFS_OP *ops, int nOps, int initial) {
+    if ((nOps > DVFS_MAX_OPS) || (initial >= nOps)) {
+        return false;
+    }
+    for (int i = 0; i < nOps; i++) {
+        uint vco, pd1, pd2;
+        if (!check_sys_clock_khz(ops[i].khz, &vco, &pd1, &pd2)) {
+            printf("DVFS: %" PRIu32 " kHz is not possible\n", ops[i].khz);
+            return false;
+        }
+    }
+    opTable = ops;
+    nOpTable = nOps;
+
+    // Go to the initial operating point
+    // (the clock is changed even if it is the same)
+    curOp = initial;
+    vreg_set_voltage(ops[initial].voltage);
+    busy_wait_us(VREG_SETTLE_US);
+    set_sys_clock_khz(ops[initial].khz, true);
+    stats[initial].entries++;
+    opStart = periodStart = time_us_64();
+    periodIdle = 0;
+    return true;
+}
+
+// Add a routine to be called when the clock changes
+bool dvfs_add_listener(dvfs_listener_t fn, void *ctx) {
+    if (nListeners == DVFS_MAX_LISTENERS) {
+        return false;
+    }
+    listeners[nListeners].fn = fn;
+    listeners[nListeners].ctx = ctx;
+    nListeners++;
+    return true;
+}
+
+// Change to an operating point
+void dvfs_set_op(int op) {
+    if ((op == curOp) || (op < 0) || (op >= nOpTable)) {
+        return;
+    }
+    const DVFS_OP *newOp = &opTable[op];
+    const DVFS_OP *oldOp = &opTable[curOp];
+
+    // Raise the voltage before raising the clock
+    if (newOp->voltage > oldOp->voltage) {
+        vreg_set_voltage(newOp->voltage);
+        busy_wait_us(VREG_SETTLE_US);
+    }
+
+    // Change clock and re-derive the dividers
+    uint32_t save = save_and_disable_interrupts();
+    set_sys_clock_khz(newOp->khz, true);
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    uint32_t peri_hz = clock_get_hz(clk_peri);
+    for (int i = 0; i < nListeners; i++) {
+        listeners[i].fn(sys_hz, peri_hz, listeners[i].ctx);
+    }
+    restore_interrupts(save);
+
+    // Lower the voltage after lowering the clock
+    if (newOp->voltage < oldOp->voltage) {
+        vreg_set_voltage(newOp->voltage);
+    }
+
+    // Update statistics
+    uint64_t now = time_us_64();
+    stats[curOp].time_us += now - opStart;
+    opStart = now;
+    stats[op].entries++;
+    curOp = op;
+}
+
+// Get current operating point
+int dvfs_get_op(void) {
+    return curOp;
+}
+
+// Wait for an interrupt, the time spent here is considered idle
+void dvfs_idle(void) {
+    uint64_t start = time_us_64();
+    __wfi();
+    uint64_t idle = time_us_64() - start;
+    periodIdle += idle;
+    stats[curOp].idle_us += idle;
+}
+
+// Account for work done by the application
+void dvfs_work(uint32_t units) {
+    stats[curOp].work += units;
+}
+
+// Evaluate the load and change the operating point if needed
+void dvfs_update(void) {
+    uint64_t now = time_us_64();
+    uint64_t elapsed = now - periodStart;
+    if (elapsed < DVFS_PERIOD_US) {
+        return;
+    }
+    uint32_t load = 100 - (uint32_t) ((periodIdle * 100) / elapsed);
+    periodStart = now;
+    periodIdle = 0;
+    if ((load > DVFS_UP_LOAD) && (curOp < (nOpTable-1))) {
+        dvfs_set_op(curOp+1);
+    } else if ((load < DVFS_DOWN_LOAD) && (curOp > 0)) {
+        dvfs_set_op(curOp-1);
+    }
+}
+
+// Print the statistics for each operating point
+// Power is estimated as proportional to f*V^2, relative to the
+// highest operating point
+void dvfs_report(void) {
+    uint64_t now = time_us_64();
+    stats[curOp].time_us += now - opStart;
+    opStart = now;
+
+    const DVFS_OP *top = &opTable[nOpTable-1];
+    float topPower = top->khz * vreg_volts(top->voltage) * vreg_volts(top->voltage);
+    printf("  MHz  Volts  Entries   Time(s)  Load%%  Work/s(busy)  RelPower  Work/Energy\n");
+    for (int i = 0; i < nOpTable; i++) {
+        DVFS_STATS *st = &stats[i];
+        float v = vreg_volts(opTable[i].voltage);
+        float relPower = (opTable[i].khz * v * v) / topPower;
+        uint64_t busy = st->time_us - st->idle_us;
+        float load = st->time_us ? (100.0f * busy) / st->time_us : 0.0f;
+        float perf = busy ? (st->work * 1000000.0f) / busy : 0.0f;
+        printf("%5.1f  %5.2f  %7" PRIu32 "  %8.1f  %5.1f  %12.1f  %8.2f  %11.1f\n",
+
+               opTable[i].khz / 1000.0f, v, st->entries, st->time_us / 1000000.0f,
+               load, perf, relPower, relPower > 0.0f ? perf / relPower : 0.0f);
+    }
+    stdio_flush();
+}
@@ -0,0 +1,66 @@
+/**
+ * @file dvfs.h
+ * @author Daniel Quadros
+ * @brief Dynamic frequency and voltage scaling governor
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _DVFS_H
+#define _DVFS_H
+
+#include "pico/stdlib.h"
+#include "hardware/vreg.h"
+
+// An operating point
+typedef struct {
+    uint32_t khz;                   // clk_sys frequency
+    enum vreg_voltage voltage;      // core voltage
+} DVFS_OP;
+
+// Routine called when the clock changes, with interrupts disabled
+// It must re-derive the dividers of the peripherals it controls
+typedef void (*dvfs_listener_t)(uint32_t sys_hz, uint32_t peri_hz, void *ctx);
+
+// Statistics for an operating point
+typedef struct {
+    uint64_t time_us;               // time spent at this operating point
+    uint64_t idle_us;               // time spent in dvfs_idle()
+    uint64_t work;                  // work units done (see dvfs_work)
+    uint32_t entries;               // number of times it was selected
+} DVFS_STATS;
+
+// Maximum number of listeners and operating points
+#define DVFS_MAX_LISTENERS  8
+#define DVFS_MAX_OPS        8
+
+// Init the governor, the operating points must be in increasing
+// order of frequency. Starts at operating point 'initial'.
+bool dvfs_init(const DVFS_OP *ops, int nOps, int initial);
+
+// Add a routine to be called when the clock changes
+bool dvfs_add_listener(dvfs_listener_t fn, void *ctx);
+
+// Change to an operating point
+void dvfs_set_op(int op);
+
+// Get current operating point
+int dvfs_get_op(void);
+
+// Wait for an interrupt, the time spent here is considered idle
+void dvfs_idle(void);
+
+// Account for work done by the application
+void dvfs_work(uint32_t units);
+
+// Evaluate the load and change the operating point if needed
+// Should be called periodically in the main loop
+void dvfs_update(void);
+
+// Print the statistics for each operating point
+void dvfs_report(void);
+
+#endif
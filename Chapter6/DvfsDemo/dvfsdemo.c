@@ -0,0 +1,199 @@
+/**
+ * @file dvfsdemo.c
+ * @author Daniel Quadros
+ * @brief Example of dynamic frequency and voltage scaling
+ *        The clock is changed according to the load and the
+ *        dividers of the peripherals are recalculated
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+#include "hardware/uart.h"
+#include "hardware/spi.h"
+#include "hardware/i2c.h"
+#include "hardware/adc.h"
+
+#include "dvfs.h"
+
+// PIO program from the SquareWave example
+#include "squarewave.pio.h"
+
+// Operating points
+static const DVFS_OP ops[] = {
+    {  48000, VREG_VOLTAGE_1_00 },
+    { 125000, VREG_VOLTAGE_1_10 },
+    { 200000, VREG_VOLTAGE_1_15 }
+};
+#define N_OPS (sizeof(ops)/sizeof(ops[0]))
+
+// Peripherals used in the example
+#define SQWAVE_PIN      28
+#define SQWAVE_FREQ     100000.0f
+#define PWM_PIN         0
+#define PWM_FREQ        1000.0f
+#define PWM_WRAP        1000
+#define UART_ID         uart1
+#define UART_TX_PIN     4
+#define UART_BAUD       115200
+#define SPI_ID          spi0
+#define SPI_BAUD        1000000
+#define I2C_ID          i2c0
+#define I2C_BAUD        100000
+#define ADC_SAMPLE_RATE 10000.0f
+
+static PIO pio = pio0;
+static uint sm;
+static uint pwmSlice;
+
+// Load: work units needed in each SLOT_US
+// The load changes every PHASE_US
+#define SLOT_US     10000
+#define PHASE_US    5000000
+static const uint32_t demand[] = { 20, 300, 50, 1200 };
+#define N_PHASES (sizeof(demand)/sizeof(demand[0]))
+
+// Clock change listeners
+// They are called with interrupts disabled, right after the change
+
+static void pio_clock_changed(uint32_t sys_hz, uint32_t peri_hz, void *ctx) {
+    sqwave_program_set_freq(pio, sm, SQWAVE_FREQ);
+}
+
+static void pwm_clock_changed(uint32_t sys_hz, uint32_t peri_hz, void *ctx) {
+    pwm_set_clkdiv(pwmSlice, sys_hz / (PWM_FREQ * (PWM_WRAP+1)));
+}
+
+static void uart_clock_changed(uint32_t sys_hz, uint32_t peri_hz, void *ctx) {
+    uart_set_baudrate(UART_ID, UART_BAUD);
+}
+
+static void spi_clock_changed(uint32_t sys_hz, uint32_t peri_hz, void *ctx) {
+    spi_set_baudrate(SPI_ID, SPI_BAUD);
+}
+
+static void i2c_clock_changed(uint32_t sys_hz, uint32_t peri_hz, void *ctx) {
+    i2c_set_baudrate(I2C_ID, I2C_BAUD);
+}
+
+static void adc_clock_changed(uint32_t sys_hz, uint32_t peri_hz, void *ctx) {
+    // clk_adc comes from the USB PLL and normally does not change
+    adc_set_clkdiv(clock_get_hz(clk_adc) / ADC_SAMPLE_RATE - 1.0f);
+}
+
+// Init the peripherals
+static void initPeripherals(void) {
+    // Square wave generated by the PIO
+    uint offset = pio_add_program(pio, &sqwave_program);
+    sm = pio_claim_unused_sm(pio, true);
+    sqwave_program_init(pio, sm, offset, SQWAVE_PIN, SQWAVE_FREQ);
+
+    // PWM with 50% duty cycle
+    pwmSlice = pwm_gpio_to_slice_num(PWM_PIN);
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_wrap(&config, PWM_WRAP);
+    pwm_config_set_clkdiv(&config, clock_get_hz(clk_sys) / (PWM_FREQ * (PWM_WRAP+1)));
+    pwm_init(pwmSlice, &config, true);
+    pwm_set_gpio_level(PWM_PIN, PWM_WRAP/2);
+    gpio_set_function(PWM_PIN, GPIO_FUNC_PWM);
+
+    // UART, SPI and I2C
+    uart_init(UART_ID, UART_BAUD);
+    gpio_set_function(UART_TX_PIN, GPIO_FUNC_UART);
+    spi_init(SPI_ID, SPI_BAUD);
+    i2c_init(I2C_ID, I2C_BAUD);
+
+    // ADC
+    adc_init();
+    adc_clock_changed(0, 0, NULL);
+
+    // Register the listeners
+    dvfs_add_listener(pio_clock_changed, NULL);
+    dvfs_add_listener(pwm_clock_changed, NULL);
+    dvfs_add_listener(uart_clock_changed, NULL);
+    dvfs_add_listener(spi_clock_changed, NULL);
+    dvfs_add_listener(i2c_clock_changed, NULL);
+    dvfs_add_listener(adc_clock_changed, NULL);
+}
+
+// A unit of work
+static volatile uint32_t result;
+static void workUnit(void) {
+    uint32_t x = result;
+    for (int i = 0; i < 1000; i++) {
+        x = x * 1664525u + 1013904223u;
+    }
+    result = x;
+}
+
+// Timer to wake up the processor
+static struct repeating_timer timer;
+static bool tick(struct repeating_timer *t) {
+    return true;
+}
+
+// Main Program
+int main() {
+    stdio_init_all();
+    #ifdef LIB_PICO_STDIO_USB
+    while (!stdio_usb_connected()) {
+        sleep_ms(100);
+    }
+    #endif
+
+    printf("DVFS Example\n\n");
+
+    // Start at the highest operating point, init peripherals
+    if (!dvfs_init(ops, N_OPS, N_OPS-1)) {
+        printf("Invalid operating points\n");
+        while (true) {
+            sleep_ms(100);
+        }
+    }
+    initPeripherals();
+    add_repeating_timer_ms(1, tick, NULL, &timer);
+
+    // Main loop
+    uint64_t slotEnd = time_us_64();
+    uint64_t nextReport = slotEnd + 4*PHASE_US;
+    int lastOp = -1;
+    while (true) {
+        // Do the work needed in this slot
+        uint32_t phase = (slotEnd / PHASE_US) % N_PHASES;
+        for (uint32_t i = 0; i < demand[phase]; i++) {
+            workUnit();
+        }
+        dvfs_work(demand[phase]);
+
+        // Wait for the end of the slot
+        slotEnd += SLOT_US;
+        while (time_us_64() < slotEnd) {
+            dvfs_idle();
+        }
+
+        // Let the governor change the clock
+        dvfs_update();
+        if (dvfs_get_op() != lastOp) {
+            lastOp = dvfs_get_op();
+            printf("clk_sys = %" PRIu32 " kHz\n", clock_get_hz(clk_sys) / 1000);
+
+        }
+        uart_putc(UART_ID, '0' + lastOp);
+
+        // Report from time to time
+        if (time_us_64() > nextReport) {
+            dvfs_report();
+            nextReport += 4*PHASE_US;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file epoch.c
+ * @author Daniel Quadros
+ * @brief Conversion between datetime_t and seconds since 01/01/2000
+ *        In the valid range (2000 to 2099) every fourth year is a
+ *        leap year, so the conversion uses tables for a four year
+ *        cycle and for the months instead of loops.
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include "epoch.h"
+
+#define SECS_PER_DAY    86400u
+#define DAYS_PER_CYCLE  1461u           // four years
+
+// Days before each month, for normal and leap years
+// (the last entry is the number of days in the year)
+static const uint16_t daysBefore[2][13] = {
+    { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365 },
+    { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366 }
+};
+
+// Days before each year of a four year cycle (the first is leap)
+static const uint16_t cycleStart[5] = { 0, 366, 731, 1096, 1461 };
+
+// Days since 01/01/2000 for a date
+static inline uint32_t days_from_date(int year, int month, int day) {
+    uint32_t y = year - 2000;
+    return (y / 4) * DAYS_PER_CYCLE + cycleStart[y % 4] +
+           daysBefore[(y % 4) == 0][month - 1] + day - 1;
+}
+
+// Check if a datetime is valid and within range
+bool epoch_valid(const datetime_t *dt) {
+    if ((dt->year < 2000) || (dt->year > 2099) ||
+        (dt->month < 1) || (dt->month > 12) || (dt->day < 1) ||
+        (dt->hour < 0) || (dt->hour > 23) || (dt->min < 0) ||
+        (dt->min > 59) || (dt->sec < 0) || (dt->sec > 59)) {
+        return false;
+    }
+    const uint16_t *days = daysBefore[(dt->year % 4) == 0];
+    return dt->day <= (days[dt->month] - days[dt->month - 1]);
+}
+
+// Convert a datetime to epoch
+epoch_t epoch_from_datetime(const datetime_t *dt) {
+    return days_from_date(dt->year, dt->month, dt->day) * SECS_PER_DAY +
+           dt->hour * 3600u + dt->min * 60u + dt->sec;
+}
+
+// Convert an epoch to a datetime
+void epoch_to_datetime(epoch_t t, datetime_t *dt) {
+    uint32_t days = t / SECS_PER_DAY;
+    uint32_t secs = t - days * SECS_PER_DAY;
+    dt->hour = secs / 3600;
+    secs -= dt->hour * 3600u;
+    dt->min = secs / 60;
+    dt->sec = secs - dt->min * 60u;
+    dt->dotw = (days + 6) % 7;      // 01/01/2000 was a Saturday
+
+    // Find the year
+    uint32_t cycle = days / DAYS_PER_CYCLE;
+    days -= cycle * DAYS_PER_CYCLE;
+    int y = days / 366;             // may be one less than the right year
+    if (days >= cycleStart[y + 1]) {
+        y++;
+    }
+    days -= cycleStart[y];
+    dt->year = 2000 + cycle * 4 + y;
+
+    // Find the month; days/32 is the right month or the one before
+    const uint16_t *before = daysBefore[y == 0];
+    int m = days / 32;
+    if (days >= before[m + 1]) {
+        m++;
+    }
+    dt->month = m + 1;
+    dt->day = days - before[m] + 1;
+}
+
+// Day of the week for a date
+int epoch_dotw(int year, int month, int day) {
+    return (days_from_date(year, month, day) + 6) % 7;
+}
+
+// Add (or subtract) seconds to a datetime
+bool epoch_add(datetime_t *dt, int32_t seconds) {
+    int64_t t = (int64_t) epoch_from_datetime(dt) + seconds;
+    if ((t < 0) || (t > EPOCH_MAX)) {
+        return false;
+    }
+    epoch_to_datetime((epoch_t) t, dt);
+    return true;
+}
+
+// Seconds from a to b
+int32_t epoch_diff(const datetime_t *a, const datetime_t *b) {
+    return (int32_t) (epoch_from_datetime(b) - epoch_from_datetime(a));
+}
+
+// Put a number with a fixed number of digits
+static inline char *put_digits(char *p, uint32_t val, int n) {
+    for (int i = n - 1; i >= 0; i--) {
+        p[i] = '0' + (val % 10);
+        val /= 10;
+    }
+    return p + n;
+}
+
+// Format a datetime as "YYYY-MM-DDTHH:MM:SS"
+char *epoch_format_iso(const datetime_t *dt, char *buf) {
+    char *p = put_digits(buf, dt->year, 4);
+    *p++ = '-';
+    p = put_digits(p, dt->month, 2);
+    *p++ = '-';
+    p = put_digits(p, dt->day, 2);
+    *p++ = 'T';
+    p = put_digits(p, dt->hour, 2);
+    *p++ = ':';
+    p = put_digits(p, dt->min, 2);
+    *p++ = ':';
+    p = put_digits(p, dt->sec, 2);
+    *p = 0;
+    return buf;
+}
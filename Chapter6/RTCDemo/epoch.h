@@ -0,0 +1,53 @@
+/**
+ * @file epoch.h
+ * @author Daniel Quadros
+ * @brief Conversion between datetime_t and seconds since 01/01/2000
+ *        This code does not access the hardware and can be used
+ *        in interrupt routines
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _EPOCH_H
+#define _EPOCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/util/datetime.h"
+
+// Seconds since 01/01/2000 00:00:00
+// Valid range is 01/01/2000 to 12/31/2099
+typedef uint32_t epoch_t;
+
+#define EPOCH_MAX       3155759999u     // 12/31/2099 23:59:59
+
+// Size of the buffer for epoch_format_iso ("YYYY-MM-DDTHH:MM:SS")
+#define EPOCH_ISO_SIZE  20
+
+// Check if a datetime is valid and within range (dotw is not checked)
+bool epoch_valid(const datetime_t *dt);
+
+// Convert a datetime to epoch (the datetime must be valid)
+epoch_t epoch_from_datetime(const datetime_t *dt);
+
+// Convert an epoch to a datetime, including the day of the week
+void epoch_to_datetime(epoch_t t, datetime_t *dt);
+
+// Day of the week (0 is Sunday) for a date
+int epoch_dotw(int year, int month, int day);
+
+// Add (or subtract, if negative) seconds to a datetime
+// Returns false if the result is out of range
+bool epoch_add(datetime_t *dt, int32_t seconds);
+
+// Seconds from a to b (b - a)
+int32_t epoch_diff(const datetime_t *a, const datetime_t *b);
+
+// Format a datetime as "YYYY-MM-DDTHH:MM:SS" (buf must have EPOCH_ISO_SIZE chars)
+// Returns buf
+char *epoch_format_iso(const datetime_t *dt, char *buf);
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file epoch_test.c
+ * @author Daniel Quadros
+ * @brief Test of epoch.c in the host, against gmtime() and timegm()
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ * Every day of the valid range is converted (at a time that changes
+ * from day to day) in both directions, and the day of the week, the
+ * validation, the date arithmetic and the ISO format are checked.
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "epoch.h"
+
+// 01/01/2000 00:00:00 in Unix time
+#define UNIX_2000   946684800LL
+
+#define SECS_DAY    86400u
+
+static int errors;
+
+static void fail(epoch_t t, const char *msg) {
+    if (errors < 20) {
+        printf("%u: %s\n", t, msg);
+    }
+    errors++;
+}
+
+// Convert with the C library
+static void lib_datetime(epoch_t t, datetime_t *dt) {
+    time_t u = (time_t) (UNIX_2000 + t);
+    struct tm tm;
+    gmtime_r(&u, &tm);
+    dt->year = tm.tm_year + 1900;
+    dt->month = tm.tm_mon + 1;
+    dt->day = tm.tm_mday;
+    dt->dotw = tm.tm_wday;
+    dt->hour = tm.tm_hour;
+    dt->min = tm.tm_min;
+    dt->sec = tm.tm_sec;
+}
+
+static bool same(const datetime_t *a, const datetime_t *b) {
+    return (a->year == b->year) && (a->month == b->month) && (a->day == b->day) &&
+           (a->dotw == b->dotw) && (a->hour == b->hour) && (a->min == b->min) &&
+           (a->sec == b->sec);
+}
+
+// Check the conversions of one time
+static void check(epoch_t t) {
+    datetime_t dt, ref;
+    lib_datetime(t, &ref);
+    epoch_to_datetime(t, &dt);
+    if (!same(&dt, &ref)) {
+        fail(t, "epoch_to_datetime differs from gmtime");
+        return;
+    }
+    if (!epoch_valid(&dt)) {
+        fail(t, "valid date rejected");
+    }
+    if (epoch_from_datetime(&dt) != t) {
+        fail(t, "epoch_from_datetime does not return the time");
+    }
+    if (epoch_dotw(dt.year, dt.month, dt.day) != ref.dotw) {
+        fail(t, "wrong day of the week");
+    }
+
+    char iso[EPOCH_ISO_SIZE], refIso[32];
+    time_t u = (time_t) (UNIX_2000 + t);
+    struct tm tm;
+    gmtime_r(&u, &tm);
+    strftime(refIso, sizeof(refIso), "%Y-%m-%dT%H:%M:%S", &tm);
+    if (strcmp(epoch_format_iso(&dt, iso), refIso) != 0) {
+        fail(t, "wrong ISO format");
+    }
+}
+
+// Check adding seconds to a time
+static void check_add(epoch_t t, int32_t seconds) {
+    datetime_t dt, ref;
+    epoch_to_datetime(t, &dt);
+    datetime_t start = dt;
+    int64_t result = (int64_t) t + seconds;
+    bool ok = epoch_add(&dt, seconds);
+    if ((result < 0) || (result > EPOCH_MAX)) {
+        if (ok) {
+            fail(t, "epoch_add out of range not detected");
+        }
+        return;
+    }
+    lib_datetime((epoch_t) result, &ref);
+    if (!ok || !same(&dt, &ref)) {
+        fail(t, "wrong epoch_add");
+    } else if (epoch_diff(&start, &dt) != seconds) {
+        fail(t, "wrong epoch_diff");
+    }
+}
+
+int main(void) {
+    uint32_t n = 0;
+
+    // Every day, the time of day changes from day to day
+    for (epoch_t day = 0; day <= EPOCH_MAX / SECS_DAY; day++) {
+        epoch_t base = day * SECS_DAY;
+        check(base);
+        check(base + SECS_DAY - 1);
+        check(base + ((day * 7919u) % SECS_DAY));
+        n += 3;
+    }
+
+    // Random times and arithmetic
+    srand(1);
+    for (int i = 0; i < 1000000; i++) {
+        epoch_t t = (epoch_t) (((uint64_t) rand() * RAND_MAX + rand()) % (EPOCH_MAX + 1ull));
+        check(t);
+        int32_t delta = (rand() % 2) ? (rand() % 200000000) : -(rand() % 200000000);
+        check_add(t, delta);
+        n++;
+    }
+    check_add(0, -1);
+    check_add(EPOCH_MAX, 1);
+    check_add(EPOCH_MAX, 0);
+
+    // Invalid dates
+    static const datetime_t invalid[] = {
+        { 1999, 12, 31, 0, 23, 59, 59 },
+        { 2100,  1,  1, 0,  0,  0,  0 },
+        { 2001,  2, 29, 0,  0,  0,  0 },
+        { 2023,  4, 31, 0,  0,  0,  0 },
+        { 2023, 13,  1, 0,  0,  0,  0 },
+        { 2023,  0,  1, 0,  0,  0,  0 },
+        { 2023,  1,  0, 0,  0,  0,  0 },
+        { 2023,  1,  1, 0, 24,  0,  0 },
+        { 2023,  1,  1, 0,  0, 60,  0 },
+        { 2023,  1,  1, 0,  0,  0, 60 },
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        if (epoch_valid(&invalid[i])) {
+            fail(i, "invalid date accepted");
+        }
+    }
+    datetime_t leap = { 2000, 2, 29, 0, 0, 0, 0 };
+    if (!epoch_valid(&leap)) {
+        fail(0, "29/02/2000 rejected");
+    }
+
+    printf("%u times tested, %d errors\n", n, errors);
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -12,29 +12,89 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <inttypes.h>
 #include "pico/stdlib.h"
 #include "pico/util/datetime.h"
 #include "hardware/rtc.h"
+#include "rtcsched.h"
+#include "epoch.h"
+#include "walltime.h"
 
-static volatile bool fired;
+// Alarm routines, called by the scheduler in thread context
 
-// This rotine will be called when the alarm fires
-static void alarm_callback(void) {
+// Print an alarm with the current time
+static void print_alarm(const char *name) {
+    char iso[WALLTIME_ISO_SIZE];
+    printf("%s alarm fired at %s\n", name, walltime_format(iso));
+}
+
+static void alarm_callback(int handle, void *ctx) {
+    print_alarm((const char *) ctx);
+}
+
+// Also show the timer rate measured against the RTC
+static void minute_callback(int handle, void *ctx) {
+    print_alarm("Every minute");
+    printf("Timer: %" PRIu32 "us per RTC second\n", walltime_us_per_sec());
+
+    if (rtcsched_dropped()) {
+        printf("Alarms lost (queue full): %" PRIu32 "\n", rtcsched_dropped());
+    }
+}
+
+// The cancelled alarm should never fire
+static void cancelled_callback(int handle, void *ctx) {
+    print_alarm("Cancelled (error!)");
+}
+
+// This alarm schedules a new one at a random time
+static void random_callback(int handle, void *ctx) {
+    print_alarm("Random");
+    uint32_t delay = 60 + (rand() % 300);
+    rtcsched_add_in(delay, 0, random_callback, NULL);
+    printf("Next random alarm in %" PRIu32 " seconds\n", delay);
+
+}
+
+// Measure the time for the epoch conversions and formatting
+#define BENCH_N 10000
+
+static void epoch_benchmark(void) {
     datetime_t dt;
+    char iso[EPOCH_ISO_SIZE];
+    char buf[256];
+    volatile epoch_t sum = 0;
 
-    // Disable alarm
-    rtc_disable_alarm();
+    absolute_time_t start = get_absolute_time();
+    for (epoch_t t = 0; t < BENCH_N; t++) {
+        epoch_to_datetime(t * 86399u, &dt);
+    }
+    int64_t toDt = absolute_time_diff_us(start, get_absolute_time());
 
-    // Get the current time and convert it to a string
-    rtc_get_datetime(&dt);
-    char datetime_buf[256];
-    char *datetime_str = &datetime_buf[0];
-    datetime_to_str(datetime_str, sizeof(datetime_buf), &dt);
-
-    // Inform alarm fired
-    printf("Alarm fired at %s\n", datetime_str);
-    stdio_flush();
-    fired = true;
+    start = get_absolute_time();
+    for (int i = 0; i < BENCH_N; i++) {
+        dt.day = 1 + (i % 28);
+        sum += epoch_from_datetime(&dt);
+    }
+    int64_t fromDt = absolute_time_diff_us(start, get_absolute_time());
+
+    start = get_absolute_time();
+    for (int i = 0; i < BENCH_N; i++) {
+        epoch_format_iso(&dt, iso);
+    }
+    int64_t fmtIso = absolute_time_diff_us(start, get_absolute_time());
+
+    start = get_absolute_time();
+    for (int i = 0; i < BENCH_N / 10; i++) {
+        datetime_to_str(buf, sizeof(buf), &dt);
+    }
+    int64_t fmtStr = absolute_time_diff_us(start, get_absolute_time()) * 10;
+
+    printf("Time for %d operations:\n", BENCH_N);
+    printf("  epoch_to_datetime:   %" PRId64 "us\n", toDt);
+    printf("  epoch_from_datetime: %" PRId64 "us\n", fromDt);
+    printf("  epoch_format_iso:    %" PRId64 "us\n", fmtIso);
+    printf("  datetime_to_str:     %" PRId64 "us\n", fmtStr);
 }
 
 
@@ -48,6 +108,7 @@ int main() {
     #endif
 
     printf("RTC Example\n");
+    epoch_benchmark();
 
     // Initializes the RTC
     datetime_t dt;
@@ -68,30 +129,38 @@ int main() {
         dt.month = dig[0]*10+dig[1];
         dt.day = dig[2]*10+dig[3];
         dt.year = dig[4]*1000+dig[5]*100+dig[6]*10+dig[7];
-        dt.dotw = 0;
         dt.hour = dig[8]*10+dig[9];
         dt.min = dig[10]*10+dig[11];
         dt.sec = dig[12]*10+dig[13];
+        if (!epoch_valid(&dt)) {
+            printf("Invalid date and time\n");
+            continue;
+        }
+        dt.dotw = epoch_dotw(dt.year, dt.month, dt.day);
         if (rtc_set_datetime(&dt)) {
             break;
         }
     }
 
-    // Main loop: set alarm and wait
-    dt.month = -1;
-    dt.day = -1;
-    dt.year = -1;
-    dt.dotw = -1;
-    dt.hour = -1;
-    while (true) {
-        fired = false;
-        dt.min = (dt.min + 1 + (rand() % 5)) % 60;
-        rtc_set_alarm(&dt, alarm_callback);
-        printf ("Alarm set for xx:%02d:%02d\n", dt.min, dt.sec);
-        while (!fired) {
-            // do nothing
-        }
-    }
+    // The new time takes a few RTC clock cycles to be set
+    sleep_us(64);
+
+    // Schedule some alarms
+    rtcsched_init();
+    walltime_init();
+    rtcsched_add_in(10, 0, alarm_callback, "One time");
+    rtcsched_add_in(15, 15, alarm_callback, "Every 15 seconds");
+    rtc_get_datetime(&dt);
+    dt.sec = 0;
+    epoch_add(&dt, 60);
+    rtcsched_add(&dt, 60, minute_callback, NULL);
+    int h = rtcsched_add_in(20, 0, cancelled_callback, NULL);
+    rtcsched_add_in(60 + (rand() % 300), 0, random_callback, NULL);
+    rtcsched_cancel(h);
+    printf("Alarms scheduled\n");
+
+    // Main loop: call the alarm routines and sleep between alarms
+    rtcsched_run(NULL);
 
     return 0;
 }
@@ -0,0 +1,303 @@
+/**
+ * @file rtcsched.c
+ * @author Daniel Quadros
+ * @brief Multiple alarms using the single RTC alarm
+ *        The alarms are kept in a binary heap ordered by time and
+ *        the nearest one is programmed in the RTC. The RTC interrupt
+ *        moves the expired alarms to a queue, their routines are
+ *        called later in thread context.
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include "pico/stdlib.h"
+#include "pico/util/queue.h"
+#include "hardware/rtc.h"
+#include "hardware/sync.h"
+#include "rtcsched.h"
+#include "epoch.h"
+
+// An alarm
+typedef struct {
+    epoch_t when;
+    uint32_t period;            // 0 for one time alarms
+    rtcsched_callback_t callback;
+    void *ctx;
+    uint32_t generation;        // incremented each time the slot is used
+} ALARM;
+
+// A fired alarm
+typedef struct {
+    int handle;
+    rtcsched_callback_t callback;
+    void *ctx;
+} FIRED;
+
+// Alarm slots
+static ALARM alarms[RTCSCHED_MAX_ALARMS];
+static int heapPos[RTCSCHED_MAX_ALARMS];   // position in heap, -1 if free
+
+// Binary heap with the indexes of the scheduled alarms
+static int heap[RTCSCHED_MAX_ALARMS];
+static int heapSize = 0;
+
+// Stack of the free slots, so adding an alarm does not search for one
+static int freeSlots[RTCSCHED_MAX_ALARMS];
+static int nFree = 0;
+
+// Queue of fired alarms
+static queue_t firedQueue;
+static uint32_t droppedCount = 0;
+
+#define SLOT_MASK   ((1 << RTCSCHED_SLOT_BITS) - 1)
+#define GEN_MASK    (0x7FFFFFFFu >> RTCSCHED_SLOT_BITS)
+
+// Handle for the alarm in a slot
+static inline int make_handle(int slot) {
+    return (int) ((alarms[slot].generation << RTCSCHED_SLOT_BITS) | slot);
+}
+
+// Slot for a handle, -1 if the handle is not for a scheduled alarm
+// Must be called with interrupts disabled
+static int handle_slot(int handle) {
+    if (handle < 0) {
+        return -1;
+    }
+    int slot = handle & SLOT_MASK;
+    if ((slot >= RTCSCHED_MAX_ALARMS) || (heapPos[slot] == -1) ||
+        (handle != make_handle(slot))) {
+        return -1;
+    }
+    return slot;
+}
+
+// Routine to be called every second, in the RTC interrupt
+static void (*tickHook)(void) = NULL;
+
+// Current time in seconds
+static epoch_t now(void) {
+    datetime_t dt;
+    rtc_get_datetime(&dt);
+    return epoch_from_datetime(&dt);
+}
+
+// Heap manipulation
+
+static inline bool earlier(int a, int b) {
+    return alarms[heap[a]].when < alarms[heap[b]].when;
+}
+
+static inline void heap_swap(int a, int b) {
+    int tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+    heapPos[heap[a]] = a;
+    heapPos[heap[b]] = b;
+}
+
+static void sift_up(int pos) {
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!earlier(pos, parent)) {
+            break;
+        }
+        heap_swap(pos, parent);
+        pos = parent;
+    }
+}
+
+static void sift_down(int pos) {
+    while (true) {
+        int child = 2 * pos + 1;
+        if (child >= heapSize) {
+            break;
+        }
+        if ((child + 1 < heapSize) && earlier(child + 1, child)) {
+            child++;
+        }
+        if (!earlier(child, pos)) {
+            break;
+        }
+        heap_swap(pos, child);
+        pos = child;
+    }
+}
+
+static void heap_insert(int slot) {
+    heap[heapSize] = slot;
+    heapPos[slot] = heapSize;
+    sift_up(heapSize++);
+}
+
+static void heap_remove(int slot) {
+    int pos = heapPos[slot];
+    heapSize--;
+    if (pos != heapSize) {
+        int moved = heap[heapSize];
+        heap[pos] = moved;
+        heapPos[moved] = pos;
+        sift_up(pos);
+        sift_down(heapPos[moved]);
+    }
+}
+
+// Return a slot to the free stack
+static inline void free_slot(int slot) {
+    heapPos[slot] = -1;
+    freeSlots[nFree++] = slot;
+}
+
+static void rtc_irq(void);
+
+// Move the expired alarms to the queue and program the next one
+// Must be called with interrupts disabled or from the RTC interrupt
+static void program_next(void) {
+    epoch_t next;
+
+    while (true) {
+        epoch_t t = now();
+        while ((heapSize > 0) && (alarms[heap[0]].when <= t)) {
+            int slot = heap[0];
+            ALARM *alarm = &alarms[slot];
+            FIRED fired = { make_handle(slot), alarm->callback, alarm->ctx };
+            if (!queue_try_add(&firedQueue, &fired)) {
+                droppedCount++;
+            }
+            if (alarm->period) {
+                // Reschedule, skipping lost periods
+                do {
+                    alarm->when += alarm->period;
+                } while (alarm->when <= t);
+                sift_down(0);
+            } else {
+                heap_remove(slot);
+                free_slot(slot);
+            }
+        }
+        if (tickHook != NULL) {
+            // Interrupt every second
+            next = t + 1;
+        } else if (heapSize > 0) {
+            next = alarms[heap[0]].when;
+        } else {
+            rtc_disable_alarm();
+            return;
+        }
+        datetime_t dt;
+        epoch_to_datetime(next, &dt);
+        dt.dotw = -1;
+        rtc_set_alarm(&dt, rtc_irq);
+        // Make sure the time did not pass the alarm while programming
+        if (now() < next) {
+            return;
+        }
+    }
+}
+
+// RTC alarm interrupt
+static void rtc_irq(void) {
+    if (tickHook != NULL) {
+        tickHook();
+    }
+    program_next();
+}
+
+// Init the scheduler
+void rtcsched_init(void) {
+    heapSize = 0;
+    nFree = 0;
+    for (int i = RTCSCHED_MAX_ALARMS - 1; i >= 0; i--) {
+        free_slot(i);
+    }
+    queue_init(&firedQueue, sizeof(FIRED), RTCSCHED_MAX_ALARMS);
+}
+
+// Add an alarm
+int rtcsched_add(const datetime_t *when, uint32_t period_s,
+                 rtcsched_callback_t callback, void *ctx) {
+    epoch_t t = epoch_from_datetime(when);
+    uint32_t save = save_and_disable_interrupts();
+    if (nFree == 0) {
+        restore_interrupts(save);
+        return -1;
+    }
+    int slot = freeSlots[--nFree];
+    alarms[slot].when = t;
+    alarms[slot].period = period_s;
+    alarms[slot].callback = callback;
+    alarms[slot].ctx = ctx;
+    alarms[slot].generation = (alarms[slot].generation + 1) & GEN_MASK;
+    int handle = make_handle(slot);
+    heap_insert(slot);
+    if (heap[0] == slot) {
+        program_next();
+    }
+    restore_interrupts(save);
+    return handle;
+}
+
+// Add an alarm 'delay_s' seconds from now
+int rtcsched_add_in(uint32_t delay_s, uint32_t period_s,
+                    rtcsched_callback_t callback, void *ctx) {
+    datetime_t dt;
+    epoch_to_datetime(now() + delay_s, &dt);
+    return rtcsched_add(&dt, period_s, callback, ctx);
+}
+
+// Cancel an alarm
+bool rtcsched_cancel(int handle) {
+    uint32_t save = save_and_disable_interrupts();
+    int slot = handle_slot(handle);
+    if (slot == -1) {
+        restore_interrupts(save);
+        return false;
+    }
+    bool first = heap[0] == slot;
+    heap_remove(slot);
+    free_slot(slot);
+    if (first) {
+        program_next();
+    }
+    restore_interrupts(save);
+    return true;
+}
+
+// Number of fired alarms lost because the queue was full
+uint32_t rtcsched_dropped(void) {
+    return droppedCount;
+}
+
+// Call the routines of the alarms that fired
+int rtcsched_dispatch(void) {
+    FIRED fired;
+    int n = 0;
+    while (queue_try_remove(&firedQueue, &fired)) {
+        fired.callback(fired.handle, fired.ctx);
+        n++;
+    }
+    return n;
+}
+
+// Dispatch the alarms and sleep while there is nothing to do
+void rtcsched_run(bool (*stop)(void)) {
+    while ((stop == NULL) || !stop()) {
+        rtcsched_dispatch();
+        // An interrupt after the test will end the __wfi
+        uint32_t save = save_and_disable_interrupts();
+        if (queue_is_empty(&firedQueue)) {
+            __wfi();
+        }
+        restore_interrupts(save);
+    }
+}
+
+// Define a routine to be called every second (NULL to stop)
+void rtcsched_set_tick(void (*tick)(void)) {
+    uint32_t save = save_and_disable_interrupts();
+    tickHook = tick;
+    program_next();
+    restore_interrupts(save);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file rtcsched.h
+ * @author Daniel Quadros
+ * @brief Multiple alarms using the single RTC alarm
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _RTCSCHED_H
+#define _RTCSCHED_H
+
+#include "pico/stdlib.h"
+#include "pico/util/datetime.h"
+
+// Maximum number of alarms
+#define RTCSCHED_MAX_ALARMS     32
+
+// A handle has the alarm slot in the low RTCSCHED_SLOT_BITS bits and a
+// generation count of the slot in the others, so the handle of an alarm
+// that already fired does not refer to a new alarm that reused the slot
+#define RTCSCHED_SLOT_BITS      8
+
+// Routine called (in thread context, by rtcsched_dispatch) when an alarm fires
+typedef void (*rtcsched_callback_t)(int handle, void *ctx);
+
+// Init the scheduler, the RTC must be running
+void rtcsched_init(void);
+
+// Add an alarm for 'when'; if period_s is not zero the alarm
+// is repeated every period_s seconds
+// Returns a handle for the alarm or -1 if there is no room
+int rtcsched_add(const datetime_t *when, uint32_t period_s,
+                 rtcsched_callback_t callback, void *ctx);
+
+// Add an alarm 'delay_s' seconds from now
+int rtcsched_add_in(uint32_t delay_s, uint32_t period_s,
+                    rtcsched_callback_t callback, void *ctx);
+
+// Cancel an alarm, returns false if it is not scheduled
+bool rtcsched_cancel(int handle);
+
+// Number of fired alarms lost because the queue was full
+uint32_t rtcsched_dropped(void);
+
+// Define a routine to be called every second, in the RTC interrupt,
+// right after the RTC second changes (NULL to stop)
+void rtcsched_set_tick(void (*tick)(void));
+
+// Call the routines of the alarms that fired
+// Returns the number of routines called
+int rtcsched_dispatch(void);
+
+// Dispatch the alarms and sleep (__wfi) while there is nothing to do
+// Returns only if stop() returns true (stop can be NULL)
+void rtcsched_run(bool (*stop)(void));
+
+#endif
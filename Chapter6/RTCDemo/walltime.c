@@ -0,0 +1,120 @@
+/**
+ * @file walltime.c
+ * @author Daniel Quadros
+ * @brief Wall clock time with microsecond resolution
+ *        The value of the timer is latched in the RTC interrupt each
+ *        time the seconds change. The time is the last RTC second plus
+ *        the timer microseconds since the latch, scaled by the measured
+ *        number of timer microseconds in a RTC second (so drift between
+ *        the clocks of the RTC and timer is corrected).
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/rtc.h"
+#include "hardware/sync.h"
+#include "rtcsched.h"
+#include "walltime.h"
+
+// The rate is measured over this number of seconds
+#define RATE_WINDOW     64
+
+// Rate is timer us per RTC second * 2^RATE_SHIFT
+#define RATE_SHIFT      8
+#define NOMINAL_RATE    (1000000ull << RATE_SHIFT)
+
+// Last latch
+static volatile epoch_t lastSec;
+static volatile uint64_t lastUs;
+static volatile bool valid = false;
+
+// Start of the rate window
+static epoch_t baseSec;
+static uint64_t baseUs;
+
+// Timer us per RTC second
+static volatile uint64_t rate = NOMINAL_RATE;
+
+// Called every second in the RTC interrupt
+static void walltime_tick(void) {
+    uint64_t us = time_us_64();
+    datetime_t dt;
+    rtc_get_datetime(&dt);
+    epoch_t sec = epoch_from_datetime(&dt);
+
+    if (!valid) {
+        baseSec = sec;
+        baseUs = us;
+        valid = true;
+    } else if (sec - baseSec >= RATE_WINDOW) {
+        rate = ((us - baseUs) << RATE_SHIFT) / (sec - baseSec);
+        baseSec = sec;
+        baseUs = us;
+    }
+    lastSec = sec;
+    lastUs = us;
+}
+
+// Start latching the timer at each RTC second
+void walltime_init(void) {
+    valid = false;
+    rate = NOMINAL_RATE;
+    rtcsched_set_tick(walltime_tick);
+}
+
+// Microseconds since 01/01/2000 00:00:00
+uint64_t walltime_us(void) {
+    uint32_t save = save_and_disable_interrupts();
+    uint64_t us = time_us_64();
+    if (!valid) {
+        // No latch yet, only seconds
+        restore_interrupts(save);
+        datetime_t dt;
+        rtc_get_datetime(&dt);
+        return (uint64_t) epoch_from_datetime(&dt) * 1000000u;
+    }
+    uint64_t elapsed = us - lastUs;
+    epoch_t sec = lastSec;
+    uint64_t r = rate;
+    restore_interrupts(save);
+
+    // Convert timer us to RTC us
+    uint64_t frac = (elapsed << RATE_SHIFT) * 1000000u / r;
+    if ((frac >= 1000000u) && (elapsed < 2000000u)) {
+        // The next tick is late, do not go beyond the second
+        frac = 999999u;
+    }
+    return (uint64_t) sec * 1000000u + frac;
+}
+
+// Current date and time, plus microseconds
+void walltime_get(datetime_t *dt, uint32_t *us) {
+    uint64_t t = walltime_us();
+    epoch_to_datetime((epoch_t) (t / 1000000u), dt);
+    *us = t % 1000000u;
+}
+
+// Format the current time as "YYYY-MM-DDTHH:MM:SS.uuuuuu"
+char *walltime_format(char *buf) {
+    datetime_t dt;
+    uint32_t us;
+    walltime_get(&dt, &us);
+    epoch_format_iso(&dt, buf);
+    char *p = buf + EPOCH_ISO_SIZE - 1;
+    *p++ = '.';
+    for (int i = 5; i >= 0; i--) {
+        p[i] = '0' + (us % 10);
+        us /= 10;
+    }
+    p[6] = 0;
+    return buf;
+}
+
+// Timer microseconds measured in a RTC second
+uint32_t walltime_us_per_sec(void) {
+    return (uint32_t) (rate >> RATE_SHIFT);
+}
@@ -0,0 +1,40 @@
+/**
+ * @file walltime.h
+ * @author Daniel Quadros
+ * @brief Wall clock time with microsecond resolution
+ *        Combines the RTC (date and time) with the timer (microseconds)
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _WALLTIME_H
+#define _WALLTIME_H
+
+#include "pico/stdlib.h"
+#include "epoch.h"
+
+// Size of the buffer for walltime_format ("YYYY-MM-DDTHH:MM:SS.uuuuuu")
+#define WALLTIME_ISO_SIZE   27
+
+// Start latching the timer at each RTC second
+// The RTC must be running and rtcsched_init() must have been called
+// Call it again after changing the RTC
+void walltime_init(void);
+
+// Microseconds since 01/01/2000 00:00:00
+uint64_t walltime_us(void);
+
+// Current date and time, plus microseconds
+void walltime_get(datetime_t *dt, uint32_t *us);
+
+// Format the current time as "YYYY-MM-DDTHH:MM:SS.uuuuuu"
+// (buf must have WALLTIME_ISO_SIZE chars), returns buf
+char *walltime_format(char *buf);
+
+// Timer microseconds measured in a RTC second (drift estimate)
+uint32_t walltime_us_per_sec(void);
+
+#endif
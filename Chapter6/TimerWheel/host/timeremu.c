@@ -0,0 +1,101 @@
+/**
+ * @file timeremu.c
+ * @author Daniel Quadros
+ * @brief Host emulation of the SDK timer functions used by timerwheel.c
+ *        The time is virtual and the alarm interrupts are called by
+ *        timeremu_run_until()
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include "timeremu.h"
+
+static uint64_t now;
+
+static struct {
+    hardware_alarm_callback_t callback;
+    uint64_t target;
+    bool armed;
+    bool forced;
+} alarms[NUM_TIMERS];
+
+uint64_t time_us_64(void) {
+    return now;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t) now;
+}
+
+void hardware_alarm_claim(uint alarm_num) {
+    alarms[alarm_num].armed = false;
+    alarms[alarm_num].forced = false;
+}
+
+void hardware_alarm_unclaim(uint alarm_num) {
+    alarms[alarm_num].callback = NULL;
+}
+
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback) {
+    alarms[alarm_num].callback = callback;
+}
+
+// As in the SDK, returns true if the target has already passed
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t) {
+    if (t <= now) {
+        alarms[alarm_num].armed = false;
+        return true;
+    }
+    alarms[alarm_num].target = t;
+    alarms[alarm_num].armed = true;
+    return false;
+}
+
+void hardware_alarm_cancel(uint alarm_num) {
+    alarms[alarm_num].armed = false;
+}
+
+void hardware_alarm_force_irq(uint alarm_num) {
+    alarms[alarm_num].forced = true;
+}
+
+void timeremu_set_time(uint64_t us) {
+    now = us;
+}
+
+uint32_t timeremu_run_until(uint64_t us) {
+    uint32_t irqs = 0;
+    while (true) {
+        // Find the next interrupt: a forced one or the nearest target
+        int next = -1;
+        for (int i = 0; i < NUM_TIMERS; i++) {
+            if (alarms[i].callback == NULL) {
+                continue;
+            }
+            if (alarms[i].forced) {
+                next = i;
+                break;
+            }
+            if (alarms[i].armed && (alarms[i].target <= us) &&
+                ((next < 0) || (alarms[i].target < alarms[next].target))) {
+                next = i;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        if (alarms[next].forced) {
+            alarms[next].forced = false;
+        } else {
+            now = alarms[next].target;
+            alarms[next].armed = false;
+        }
+        alarms[next].callback(next);
+        irqs++;
+    }
+    now = us;
+    return irqs;
+}
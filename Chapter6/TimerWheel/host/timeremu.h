@@ -0,0 +1,50 @@
+/**
+ * @file timeremu.h
+ * @author Daniel Quadros
+ * @brief Host emulation of the SDK timer functions used by timerwheel.c
+ *        The time is virtual and the alarm interrupts are called by
+ *        timeremu_run_until()
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _TIMEREMU_H
+#define _TIMEREMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// Time
+typedef uint64_t absolute_time_t;
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+static inline void update_us_since_boot(absolute_time_t *t, uint64_t us) { *t = us; }
+
+// Interrupts (the alarm "interrupts" are called by timeremu_run_until)
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void) status; }
+
+// Hardware alarms
+#define NUM_TIMERS  4
+typedef void (*hardware_alarm_callback_t)(uint alarm_num);
+void hardware_alarm_claim(uint alarm_num);
+void hardware_alarm_unclaim(uint alarm_num);
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback);
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t);
+void hardware_alarm_cancel(uint alarm_num);
+void hardware_alarm_force_irq(uint alarm_num);
+
+// Emulation control
+// Set the time (it must not go back)
+void timeremu_set_time(uint64_t us);
+// Advance the time to 'us', calling the alarm callbacks at their targets
+// Returns the number of interrupts
+uint32_t timeremu_run_until(uint64_t us);
+
+#endif
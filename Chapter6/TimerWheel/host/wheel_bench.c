@@ -0,0 +1,289 @@
+/**
+ * @file wheel_bench.c
+ * @author Daniel Quadros
+ * @brief Host benchmark and test of the timing wheel against a binary
+ *        heap, as used by the SDK alarm pool
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ * The SDK alarm pool keeps its alarms in a heap ordered by target and
+ * programs the hardware alarm for the first one; it is limited to 255
+ * alarms, so the comparison with more timers is done here. Both use the
+ * emulated hardware alarm (virtual time) and the times of start, stop
+ * and expiry are measured in the host.
+ * The number of expirations and the time of each one are checked.
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "timerwheel.h"
+
+// Hardware alarms
+#define WHEEL_ALARM     1
+#define HEAP_ALARM      2
+
+// The wheel ticks every ms
+#define TICK_US         1000
+
+// Timers are periodic, with this period (ms)
+#define PERIOD_MS       100
+
+// Time to run the timers (ms)
+#define RUN_MS          2000
+
+// Number of timers for each test
+static const uint nTimers[] = { 1000, 10000 };
+#define N_TESTS (sizeof(nTimers)/sizeof(nTimers[0]))
+#define MAX_TIMERS  10000
+
+static uint32_t delays[MAX_TIMERS];     // first expiration (ms)
+static uint32_t expired;
+static int errors;
+
+// Current time in nanoseconds
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void fail(const char *msg) {
+    if (errors < 20) {
+        printf("Error: %s\n", msg);
+    }
+    errors++;
+}
+
+// Expirations expected for n timers in RUN_MS
+static uint32_t expected(uint n) {
+    uint32_t total = 0;
+    for (uint i = 0; i < n; i++) {
+        total += (RUN_MS - delays[i]) / PERIOD_MS + 1;
+    }
+    return total;
+}
+
+// Show the results of a test
+static void show_results(const char *name, uint n, uint64_t startNs, uint64_t stopNs,
+                         uint64_t runNs, uint32_t irqs) {
+    printf("%-14s %5u  start %4" PRIu64 "ns  stop %4" PRIu64 "ns  expire %4" PRIu64
+           "ns  (%" PRIu32 " expired, %" PRIu32 " irqs)\n",
+           name, n, startNs / n, stopNs / n, expired ? runNs / expired : 0, expired, irqs);
+    if (expired != expected(n)) {
+        fail("wrong number of expirations");
+    }
+}
+
+// Wheel test
+
+static wheel_timer_t timers[MAX_TIMERS];
+
+// Timer callback, the current tick must be the one the timer expired
+static void wheel_callback(wheel_timer_t *timer, void *ctx) {
+    uint32_t tick = timer->expires - timer->period;
+    if ((wheel_now() != tick) || (time_us_64() != (uint64_t) tick * TICK_US)) {
+        fail("wheel timer expired at the wrong time");
+    }
+    expired++;
+}
+
+static void test_wheel(uint n, bool tickless) {
+    uint64_t base = time_us_64();
+    wheel_init(WHEEL_ALARM, TICK_US, tickless);
+    for (uint i = 0; i < n; i++) {
+        wheel_timer_init(&timers[i], wheel_callback, NULL);
+    }
+
+    uint64_t start = now_ns();
+    for (uint i = 0; i < n; i++) {
+        wheel_start(&timers[i], delays[i], PERIOD_MS);
+    }
+    uint64_t startNs = now_ns() - start;
+
+    expired = 0;
+    start = now_ns();
+    uint32_t irqs = timeremu_run_until(base + RUN_MS * 1000);
+    uint64_t runNs = now_ns() - start;
+
+    start = now_ns();
+    for (uint i = 0; i < n; i++) {
+        if (!wheel_stop(&timers[i])) {
+            fail("wheel timer not running");
+        }
+    }
+    uint64_t stopNs = now_ns() - start;
+    wheel_deinit();
+
+    show_results(tickless ? "wheel tickless" : "wheel ticking", n, startNs, stopNs,
+                 runNs, irqs);
+}
+
+// Binary heap test
+// Add, cancel and each expiration are O(log n), as in the alarm pool
+
+typedef struct {
+    uint64_t target;
+    uint32_t period;                // us
+    int32_t pos;                    // -1 if not in the heap
+} HEAP_ALARM_T;
+
+static HEAP_ALARM_T alarms[MAX_TIMERS];
+static HEAP_ALARM_T *heap[MAX_TIMERS];
+static uint heapSize;
+
+static void heap_set(uint pos, HEAP_ALARM_T *a) {
+    heap[pos] = a;
+    a->pos = pos;
+}
+
+static void sift_up(uint pos) {
+    HEAP_ALARM_T *a = heap[pos];
+    while (pos > 0) {
+        uint parent = (pos - 1) / 2;
+        if (heap[parent]->target <= a->target) {
+            break;
+        }
+        heap_set(pos, heap[parent]);
+        pos = parent;
+    }
+    heap_set(pos, a);
+}
+
+static void sift_down(uint pos) {
+    HEAP_ALARM_T *a = heap[pos];
+    while (true) {
+        uint child = 2 * pos + 1;
+        if (child >= heapSize) {
+            break;
+        }
+        if ((child + 1 < heapSize) && (heap[child + 1]->target < heap[child]->target)) {
+            child++;
+        }
+        if (a->target <= heap[child]->target) {
+            break;
+        }
+        heap_set(pos, heap[child]);
+        pos = child;
+    }
+    heap_set(pos, a);
+}
+
+static void heap_insert(HEAP_ALARM_T *a) {
+    heap[heapSize] = a;
+    sift_up(heapSize++);
+}
+
+static void heap_remove(HEAP_ALARM_T *a) {
+    uint pos = a->pos;
+    a->pos = -1;
+    if (pos != --heapSize) {
+        // Move the last one to the hole
+        HEAP_ALARM_T *last = heap[heapSize];
+        heap_set(pos, last);
+        sift_up(pos);
+        sift_down(last->pos);
+    }
+}
+
+// Alarm interrupt: expire the alarms and program the next target
+static void heap_irq(uint alarm_num) {
+    do {
+        uint64_t now = time_us_64();
+        while ((heapSize > 0) && (heap[0]->target <= now)) {
+            HEAP_ALARM_T *a = heap[0];
+            heap_remove(a);
+            if (a->target != now) {
+                fail("heap alarm expired at the wrong time");
+            }
+            expired++;
+            if (a->period) {
+                a->target += a->period;
+                heap_insert(a);
+            }
+        }
+    } while ((heapSize > 0) && hardware_alarm_set_target(HEAP_ALARM, heap[0]->target));
+}
+
+static void heap_add(HEAP_ALARM_T *a, uint32_t delayUs, uint32_t periodUs) {
+    uint32_t save = save_and_disable_interrupts();
+    a->target = time_us_64() + delayUs;
+    a->period = periodUs;
+    heap_insert(a);
+    if ((a->pos == 0) && hardware_alarm_set_target(HEAP_ALARM, a->target)) {
+        hardware_alarm_force_irq(HEAP_ALARM);
+    }
+    restore_interrupts(save);
+}
+
+static bool heap_cancel(HEAP_ALARM_T *a) {
+    uint32_t save = save_and_disable_interrupts();
+    bool running = a->pos >= 0;
+    if (running) {
+        heap_remove(a);
+    }
+    restore_interrupts(save);
+    return running;
+}
+
+static void test_heap(uint n) {
+    uint64_t base = time_us_64();
+    hardware_alarm_claim(HEAP_ALARM);
+    hardware_alarm_set_callback(HEAP_ALARM, heap_irq);
+    heapSize = 0;
+
+    uint64_t start = now_ns();
+    for (uint i = 0; i < n; i++) {
+        heap_add(&alarms[i], delays[i] * 1000, PERIOD_MS * 1000);
+    }
+    uint64_t startNs = now_ns() - start;
+
+    expired = 0;
+    start = now_ns();
+    uint32_t irqs = timeremu_run_until(base + RUN_MS * 1000);
+    uint64_t runNs = now_ns() - start;
+
+    start = now_ns();
+    for (uint i = 0; i < n; i++) {
+        if (!heap_cancel(&alarms[i])) {
+            fail("heap alarm not running");
+        }
+    }
+    uint64_t stopNs = now_ns() - start;
+    hardware_alarm_cancel(HEAP_ALARM);
+    hardware_alarm_unclaim(HEAP_ALARM);
+
+    show_results("binary heap", n, startNs, stopNs, runNs, irqs);
+}
+
+// Main program
+int main(void) {
+    printf("Timing wheel against a binary heap, period %ums, run %ums, times per timer\n\n",
+           PERIOD_MS, RUN_MS);
+    srand(1);
+    for (uint i = 0; i < MAX_TIMERS; i++) {
+        delays[i] = 1 + (rand() % PERIOD_MS);
+    }
+
+    uint64_t time = 1000000;
+    for (uint i = 0; i < N_TESTS; i++) {
+        timeremu_set_time(time);
+        test_wheel(nTimers[i], false);
+        time += 2 * RUN_MS * 1000;
+        timeremu_set_time(time);
+        test_wheel(nTimers[i], true);
+        time += 2 * RUN_MS * 1000;
+        timeremu_set_time(time);
+        test_heap(nTimers[i]);
+        time += 2 * RUN_MS * 1000;
+        printf("\n");
+    }
+
+    printf("%d errors\n", errors);
+    return errors ? 1 : 0;
+}
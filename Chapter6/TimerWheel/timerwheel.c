@@ -0,0 +1,273 @@
+/**
+ * @file timerwheel.c
+ * @author Daniel Quadros
+ * @brief Hierarchical timing wheel using a single hardware alarm
+ *        Level 0 has one slot per tick; each slot of level n covers
+ *        a full turn of level n-1. When level 0 completes a turn, the
+ *        timers in the next slot of level 1 are moved down (and so on).
+ *        Timers are kept in doubly linked lists, so start and stop are
+ *        O(1). A bitmap per level marks the non empty slots, used to
+ *        find the next tick with something to do.
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+#include "timerwheel.h"
+
+#define SLOT_MASK   (WHEEL_SLOTS - 1)
+
+// The wheel
+static wheel_timer_t *slots[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint64_t used[WHEEL_LEVELS];    // bitmap of non empty slots
+
+static uint alarmNum;
+static uint32_t tickUs;
+static bool tickless;
+static uint32_t current;               // last processed tick
+static uint32_t programmed;            // tick programmed in the alarm
+static bool armed;
+static bool inIrq;
+
+static WHEEL_STATS stats;
+
+// Tick for the current time
+static inline uint32_t tick_now(void) {
+    return (uint32_t) (time_us_64() / tickUs);
+}
+
+// Put a timer in the right slot
+// When cascading, timers expiring at the current tick go to the
+// current slot, that will be processed next
+static void wheel_insert(wheel_timer_t *timer, bool cascading) {
+    int32_t delta = (int32_t) (timer->expires - current);
+    if ((delta < 0) || ((delta == 0) && !cascading)) {
+        // Already expired, expire in the next tick
+        timer->expires = current + 1;
+        delta = 1;
+    } else if (delta > WHEEL_MAX_DELAY) {
+        timer->expires = current + WHEEL_MAX_DELAY;
+        delta = WHEEL_MAX_DELAY;
+    }
+    uint level = 0;
+    while (delta >= (int32_t) (1u << (WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    uint slot = (timer->expires >> (WHEEL_BITS * level)) & SLOT_MASK;
+
+    timer->level = level;
+    timer->slot = slot;
+    timer->next = slots[level][slot];
+    if (timer->next != NULL) {
+        timer->next->pprev = &timer->next;
+    }
+    slots[level][slot] = timer;
+    timer->pprev = &slots[level][slot];
+    used[level] |= 1ull << slot;
+}
+
+// Take a timer out of its slot
+static void wheel_remove(wheel_timer_t *timer) {
+    *timer->pprev = timer->next;
+    if (timer->next != NULL) {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->pprev = NULL;
+    if (slots[timer->level][timer->slot] == NULL) {
+        used[timer->level] &= ~(1ull << timer->slot);
+    }
+}
+
+// Move the timers of a slot to the lower levels
+static void cascade(uint level, uint slot) {
+    wheel_timer_t *timer = slots[level][slot];
+    slots[level][slot] = NULL;
+    used[level] &= ~(1ull << slot);
+    while (timer != NULL) {
+        wheel_timer_t *next = timer->next;
+        wheel_insert(timer, true);
+        stats.cascaded++;
+        timer = next;
+    }
+}
+
+// Call the callbacks of the timers in a level 0 slot
+static void expire(uint slot) {
+    wheel_timer_t *timer;
+    while ((timer = slots[0][slot]) != NULL) {
+        wheel_remove(timer);
+        if (timer->period) {
+            timer->expires += timer->period;
+            wheel_insert(timer, false);
+        }
+        stats.expired++;
+        timer->callback(timer, timer->ctx);
+    }
+}
+
+// Next tick with something to do: a non empty slot in level 0
+// before the end of the turn or the end of the turn (cascade)
+static uint32_t next_event(void) {
+    uint idx = current & SLOT_MASK;
+    uint64_t pending = (idx == SLOT_MASK) ? 0 : used[0] & (~0ull << (idx + 1));
+    if (pending) {
+        return current - idx + __builtin_ctzll(pending);
+    }
+    return (current | SLOT_MASK) + 1;
+}
+
+// Check if there is any timer running
+static inline bool wheel_empty(void) {
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        if (used[level]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Process all ticks up to 'target'
+static void advance(uint32_t target) {
+    while ((int32_t) (target - current) > 0) {
+        uint32_t next = next_event();
+        if ((int32_t) (next - target) > 0) {
+            current = target;
+            break;
+        }
+        current = next;
+        uint idx = current & SLOT_MASK;
+        if (idx == 0) {
+            // Level 0 turned, cascade the next levels
+            for (uint level = 1; level < WHEEL_LEVELS; level++) {
+                uint slot = (current >> (WHEEL_BITS * level)) & SLOT_MASK;
+                cascade(level, slot);
+                if (slot != 0) {
+                    break;
+                }
+            }
+        }
+        expire(idx);
+    }
+}
+
+// Program the alarm for the next tick with something to do
+static void program_alarm(void) {
+    uint32_t next;
+    if (!tickless) {
+        next = current + 1;
+    } else if (wheel_empty()) {
+        hardware_alarm_cancel(alarmNum);
+        armed = false;
+        return;
+    } else {
+        next = next_event();
+    }
+    programmed = next;
+    armed = true;
+    absolute_time_t t;
+    update_us_since_boot(&t, (uint64_t) next * tickUs);
+    if (hardware_alarm_set_target(alarmNum, t)) {
+        // Missed it, let the interrupt handle it
+        hardware_alarm_force_irq(alarmNum);
+    }
+}
+
+// Alarm interrupt
+static void wheel_irq(uint alarm_num) {
+    uint32_t start = time_us_32();
+    stats.irqs++;
+    armed = false;
+    inIrq = true;
+    advance(tick_now());
+    inIrq = false;
+    program_alarm();
+    stats.busy_us += time_us_32() - start;
+}
+
+// Init the wheel
+void wheel_init(uint alarm_num, uint32_t tick_us, bool tickless_mode) {
+    alarmNum = alarm_num;
+    tickUs = tick_us;
+    tickless = tickless_mode;
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < WHEEL_SLOTS; slot++) {
+            slots[level][slot] = NULL;
+        }
+        used[level] = 0;
+    }
+    memset(&stats, 0, sizeof(stats));
+    current = tick_now();
+    armed = false;
+    inIrq = false;
+    hardware_alarm_claim(alarmNum);
+    hardware_alarm_set_callback(alarmNum, wheel_irq);
+    if (!tickless) {
+        program_alarm();
+    }
+}
+
+// Stop using the wheel, the timers are abandoned
+void wheel_deinit(void) {
+    hardware_alarm_cancel(alarmNum);
+    hardware_alarm_set_callback(alarmNum, NULL);
+    hardware_alarm_unclaim(alarmNum);
+}
+
+// Init a timer
+void wheel_timer_init(wheel_timer_t *timer, wheel_callback_t callback, void *ctx) {
+    timer->pprev = NULL;
+    timer->next = NULL;
+    timer->callback = callback;
+    timer->ctx = ctx;
+}
+
+// Start (or restart) a timer
+void wheel_start(wheel_timer_t *timer, uint32_t delay, uint32_t period) {
+    uint32_t save = save_and_disable_interrupts();
+    if (timer->pprev != NULL) {
+        wheel_remove(timer);
+    }
+    if (wheel_empty()) {
+        // Nothing to process, the wheel can jump to the current time
+        current = tick_now();
+    }
+    // Ticks not processed yet count for the delay
+    timer->expires = tick_now() + delay;
+    timer->period = period;
+    wheel_insert(timer, false);
+    // The interrupt reprograms the alarm when it ends
+    if (tickless && !inIrq &&
+        (!armed || ((int32_t) (timer->expires - programmed) < 0))) {
+        program_alarm();
+    }
+    restore_interrupts(save);
+}
+
+// Stop a timer
+bool wheel_stop(wheel_timer_t *timer) {
+    uint32_t save = save_and_disable_interrupts();
+    bool running = timer->pprev != NULL;
+    if (running) {
+        wheel_remove(timer);
+    }
+    restore_interrupts(save);
+    return running;
+}
+
+// Current tick
+uint32_t wheel_now(void) {
+    return current;
+}
+
+// Get a copy of the statistics
+void wheel_get_stats(WHEEL_STATS *st) {
+    uint32_t save = save_and_disable_interrupts();
+    *st = stats;
+    restore_interrupts(save);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file timerwheel.h
+ * @author Daniel Quadros
+ * @brief Hierarchical timing wheel using a single hardware alarm
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _TIMERWHEEL_H
+#define _TIMERWHEEL_H
+
+#include "pico/stdlib.h"
+
+// Wheel geometry: WHEEL_LEVELS levels of 2^WHEEL_BITS slots
+// The maximum delay is 2^(WHEEL_BITS*WHEEL_LEVELS)-1 ticks
+#define WHEEL_BITS      6
+#define WHEEL_LEVELS    4
+#define WHEEL_SLOTS     (1u << WHEEL_BITS)
+#define WHEEL_MAX_DELAY ((1u << (WHEEL_BITS*WHEEL_LEVELS)) - 1)
+
+struct wheel_timer;
+
+// Routine called (in interrupt context) when a timer expires
+typedef void (*wheel_callback_t)(struct wheel_timer *timer, void *ctx);
+
+// A timer, the memory is supplied by the caller
+typedef struct wheel_timer {
+    struct wheel_timer *next;
+    struct wheel_timer **pprev;     // NULL if not running
+    uint32_t expires;               // tick
+    uint32_t period;                // in ticks, 0 for one-shot
+    wheel_callback_t callback;
+    void *ctx;
+    uint8_t level;
+    uint8_t slot;
+} wheel_timer_t;
+
+// Statistics
+typedef struct {
+    uint32_t irqs;                  // alarm interrupts
+    uint32_t expired;               // callbacks called
+    uint32_t cascaded;              // timers moved to a lower level
+    uint64_t busy_us;               // time spent in the interrupt
+} WHEEL_STATS;
+
+// Init the wheel, using hardware alarm 'alarm_num' (it will be claimed)
+// If tickless is true, the alarm is programmed for the next non empty
+// slot, else it interrupts every tick
+void wheel_init(uint alarm_num, uint32_t tick_us, bool tickless);
+
+// Stop using the wheel and release the hardware alarm
+void wheel_deinit(void);
+
+// Init a timer
+void wheel_timer_init(wheel_timer_t *timer, wheel_callback_t callback, void *ctx);
+
+// Start (or restart) a timer to expire after 'delay' ticks,
+// and then every 'period' ticks (if not zero)
+void wheel_start(wheel_timer_t *timer, uint32_t delay, uint32_t period);
+
+// Stop a timer, returns false if it was not running
+bool wheel_stop(wheel_timer_t *timer);
+
+// Check if a timer is running
+static inline bool wheel_is_running(wheel_timer_t *timer) {
+    return timer->pprev != NULL;
+}
+
+// Current tick
+uint32_t wheel_now(void);
+
+// Get a copy of the statistics
+void wheel_get_stats(WHEEL_STATS *stats);
+
+#endif
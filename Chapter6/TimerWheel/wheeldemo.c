@@ -0,0 +1,171 @@
+/**
+ * @file wheeldemo.c
+ * @author Daniel Quadros
+ * @brief Benchmark of the timing wheel against the SDK alarm pool
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+#include "timerwheel.h"
+
+// Hardware alarms (the SDK default alarm pool uses alarm 3)
+#define WHEEL_ALARM     1
+#define POOL_ALARM      2
+
+// The wheel ticks every ms
+#define TICK_US         1000
+
+// Timers are periodic, with this period (ms)
+#define PERIOD_MS       100
+
+// Time to measure the load (ms)
+#define LOAD_MS         2000
+
+// Number of timers for each test
+// The alarm pool is limited to 255 timers; the wheel timers are
+// limited by the RAM (each one uses 28 bytes)
+// The comparison with more timers (1000 and 10000) is done by the
+// benchmark in the host directory
+static const uint nTimers[] = { 250, 1000, 5000 };
+#define N_TESTS (sizeof(nTimers)/sizeof(nTimers[0]))
+#define MAX_TIMERS  5000
+#define POOL_TIMERS 250
+
+static wheel_timer_t timers[MAX_TIMERS];
+static alarm_id_t alarmIds[POOL_TIMERS];
+static volatile uint32_t expired;
+
+// Wheel timer callback
+static void wheel_callback(wheel_timer_t *timer, void *ctx) {
+    expired++;
+}
+
+// Alarm pool callback, returns a negative value to repeat
+// relative to the previous target
+static int64_t pool_callback(alarm_id_t id, void *user_data) {
+    expired++;
+    return -PERIOD_MS * 1000;
+}
+
+// Count loop iterations for LOAD_MS; with interrupts taking CPU time
+// there will be less iterations
+static uint32_t idle_count(void) {
+    uint32_t count = 0;
+    absolute_time_t end = make_timeout_time_ms(LOAD_MS);
+    while (!time_reached(end)) {
+        count++;
+    }
+    return count;
+}
+
+// Show the results of a test
+static void show_results(const char *name, uint n, uint32_t startUs, uint32_t stopUs,
+                         uint32_t count, uint32_t baseline, uint32_t nExpired) {
+    // CPU time taken from the idle loop, divided by the expirations
+    uint64_t lostUs = ((uint64_t) (baseline - count) * LOAD_MS * 1000) / baseline;
+    printf("%-6s %5u  start %5" PRIu32 "ns  stop %5" PRIu32 "ns  expire %5" PRIu64
+           "ns  (%" PRIu32 " expired, load %u%%)\n",
+           name, n, (startUs * 1000) / n, (stopUs * 1000) / n,
+           nExpired ? (lostUs * 1000) / nExpired : 0, nExpired,
+
+           (uint) ((100 * lostUs) / (LOAD_MS * 1000)));
+}
+
+// Test the wheel with n timers
+static void test_wheel(uint n, uint32_t baseline) {
+    for (uint i = 0; i < n; i++) {
+        wheel_timer_init(&timers[i], wheel_callback, NULL);
+    }
+
+    uint32_t start = time_us_32();
+    for (uint i = 0; i < n; i++) {
+        wheel_start(&timers[i], 1 + (rand() % PERIOD_MS), PERIOD_MS);
+    }
+    uint32_t startUs = time_us_32() - start;
+
+    expired = 0;
+    uint32_t count = idle_count();
+    uint32_t nExpired = expired;
+
+    start = time_us_32();
+    for (uint i = 0; i < n; i++) {
+        wheel_stop(&timers[i]);
+    }
+    uint32_t stopUs = time_us_32() - start;
+
+    show_results("wheel", n, startUs, stopUs, count, baseline, nExpired);
+}
+
+// Test the alarm pool with n timers
+static void test_pool(alarm_pool_t *pool, uint n, uint32_t baseline) {
+    uint32_t start = time_us_32();
+    for (uint i = 0; i < n; i++) {
+        alarmIds[i] = alarm_pool_add_alarm_in_ms(pool, 1 + (rand() % PERIOD_MS),
+                                                 pool_callback, NULL, true);
+    }
+    uint32_t startUs = time_us_32() - start;
+
+    expired = 0;
+    uint32_t count = idle_count();
+    uint32_t nExpired = expired;
+
+    start = time_us_32();
+    for (uint i = 0; i < n; i++) {
+        alarm_pool_cancel_alarm(pool, alarmIds[i]);
+    }
+    uint32_t stopUs = time_us_32() - start;
+
+    show_results("pool", n, startUs, stopUs, count, baseline, nExpired);
+}
+
+// Main program
+int main() {
+    stdio_init_all();
+    #ifdef LIB_PICO_STDIO_USB
+    while (!stdio_usb_connected()) {
+        sleep_ms(100);
+    }
+    #endif
+
+    printf("Timing Wheel Example\n\n");
+    printf("%u timers max, period %ums, times per timer\n\n", MAX_TIMERS, PERIOD_MS);
+
+    alarm_pool_t *pool = alarm_pool_create(POOL_ALARM, POOL_TIMERS);
+
+    while (true) {
+        uint32_t baseline = idle_count();
+
+        // Tick every ms
+        wheel_init(WHEEL_ALARM, TICK_US, false);
+        printf("Wheel ticking every ms\n");
+        for (uint i = 0; i < N_TESTS; i++) {
+            test_wheel(nTimers[i], baseline);
+        }
+        wheel_deinit();
+
+        // Tickless
+        wheel_init(WHEEL_ALARM, TICK_US, true);
+        printf("Tickless wheel\n");
+        for (uint i = 0; i < N_TESTS; i++) {
+            test_wheel(nTimers[i], baseline);
+        }
+        wheel_deinit();
+
+        // SDK alarm pool
+        printf("SDK alarm pool\n");
+        test_pool(pool, POOL_TIMERS, baseline);
+
+        printf("\n");
+        sleep_ms(5000);
+    }
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file warmboot.c
+ * @author Daniel Quadros
+ * @brief Keeping the application state across watchdog reboots
+ *        The RAM is not cleared by a watchdog reboot, but the runtime
+ *        initializes .data and .bss. Two copies of the state are kept
+ *        in .uninitialized_data, each with a sequence number and a CRC.
+ *        A save writes the older copy and then puts its sequence number
+ *        in a watchdog scratch register (these are cleared at power up),
+ *        so a reboot in the middle of a save finds the previous copy.
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/watchdog.h"
+#include "warmboot.h"
+
+#define SCRATCH_SEQ 3
+
+// A copy of the state
+typedef struct {
+    uint32_t seq;           // sequence number of the save, never zero
+    uint32_t crc;           // of the data
+    uint32_t data[WARMBOOT_MAX_SIZE / sizeof(uint32_t)];
+} STATE_COPY;
+
+// Copy n is used by the saves with the low bit of seq equal to n
+static STATE_COPY __uninitialized_ram(copies)[2];
+
+// CRC-32 (the usual, reflected 0xEDB88320 polynomial)
+static uint32_t crc32(const void *data, size_t size) {
+    const uint8_t *p = (const uint8_t *) data;
+    uint32_t crc = 0xFFFFFFFF;
+    while (size--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+// Check if the copy for save 'seq' is valid
+static bool copy_valid(uint32_t seq, size_t size) {
+    const STATE_COPY *copy = &copies[seq & 1];
+    return (seq != 0) && (copy->seq == seq) && (copy->crc == crc32(copy->data, size));
+}
+
+// Check if this is a warm boot
+// The last save should be complete, the previous one is tried in case
+// the copy was damaged
+bool warmboot_check(void *state, size_t size) {
+    if (!watchdog_caused_reboot() || (size > WARMBOOT_MAX_SIZE)) {
+        return false;
+    }
+    uint32_t seq = watchdog_hw->scratch[SCRATCH_SEQ];
+    if (!copy_valid(seq, size)) {
+        seq--;
+        if (!copy_valid(seq, size)) {
+            return false;
+        }
+        watchdog_hw->scratch[SCRATCH_SEQ] = seq;
+    }
+    memcpy(state, copies[seq & 1].data, size);
+    return true;
+}
+
+// Save the state in the other copy
+void warmboot_save(const void *state, size_t size) {
+    if (size > WARMBOOT_MAX_SIZE) {
+        return;
+    }
+    uint32_t seq = watchdog_hw->scratch[SCRATCH_SEQ] + 1;
+    if (seq == 0) {
+        seq = 2;        // skip zero, keeping the copies alternating
+    }
+    STATE_COPY *copy = &copies[seq & 1];
+    copy->seq = seq;
+    memcpy(copy->data, state, size);
+    copy->crc = crc32(copy->data, size);
+    watchdog_hw->scratch[SCRATCH_SEQ] = seq;
+}
+
+// Invalidate the state
+void warmboot_invalidate(void) {
+    watchdog_hw->scratch[SCRATCH_SEQ] = 0;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file warmboot.h
+ * @author Daniel Quadros
+ * @brief Keeping the application state across watchdog reboots
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _WARMBOOT_H
+#define _WARMBOOT_H
+
+#include "pico/stdlib.h"
+
+// Maximum size of the state
+#define WARMBOOT_MAX_SIZE   256
+
+// The application works on its state in a normal variable; warmboot
+// keeps two copies of it in memory not initialized by the runtime
+
+// Check if this is a warm boot: a reboot by the watchdog with a state
+// saved by warmboot_save() still valid; if so it is copied to 'state'
+bool warmboot_check(void *state, size_t size);
+
+// Save the state after changes (in the copy not used by the last
+// save, the sequence number of the save goes in watchdog scratch[3]
+// when the copy is complete)
+void warmboot_save(const void *state, size_t size);
+
+// Invalidate the state, the next boot will be cold
+void warmboot_invalidate(void);
+
+#endif
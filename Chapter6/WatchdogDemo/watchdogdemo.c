@@ -11,34 +11,140 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
 #include "hardware/watchdog.h"
+#include "wdsuper.h"
+#include "warmboot.h"
+
+// Tasks supervised
+// They are always registered in the same order, so the ids
+// are the same after a reboot
+static int taskMain;
+static int taskWorker;
+
+// Application state, kept in a warm boot
+#define LINE_LEN    32
+
+typedef struct {
+    uint32_t boots;                 // number of boots (since cold boot)
+    uint32_t warmBoots;
+    uint32_t coldUs;                // time to operational (us)
+    uint32_t warmUs;
+    uint32_t mainLoops;             // counters
+    uint32_t workerLoops;
+    uint32_t maxSleep;              // configuration
+    bool crashed;                   // last reboot info
+    WDSUPER_CRASH crash;
+    uint32_t lineLen;               // output line being built
+    char line[LINE_LEN+1];
+} APP_STATE;
+
+// Working copy, warmboot keeps the saved ones
+static APP_STATE state;
+static_assert(sizeof(APP_STATE) <= WARMBOOT_MAX_SIZE, "APP_STATE is too big for warmboot");
+
+// Worker loop counter (updated by core 1)
+static volatile uint32_t workerLoops;
+
+// A task running in core 1
+// Its work takes a random time, sometimes more than the deadline
+void worker() {
+    uint32_t seed = 1 + workerLoops;
+    while (true) {
+        seed = seed * 1103515245 + 12345;
+        sleep_ms((seed >> 16) % 520);    // 0 to 519ms
+        wdsuper_checkin(taskWorker);
+        workerLoops++;
+    }
+}
+
+// Show the boot information
+// On a warm boot the USB host may not be connected yet, so this is
+// repeated from time to time
+static void report(void) {
+    printf("\nBoot %" PRIu32 " (%" PRIu32 " warm), operational after %" PRIu32
+           "us (cold) / %" PRIu32 "us (warm)\n",
+           state.boots, state.warmBoots, state.coldUs, state.warmUs);
+    if (state.crashed) {
+        printf("Last reboot by Watchdog: task %s was %" PRIu32 "ms late\n",
+               wdsuper_task_name(state.crash.task), state.crash.late_ms);
+        printf("Last check in from 0x%08" PRIX32 ", uptime %" PRIu32 "ms\n",
+               state.crash.pc, state.crash.uptime_ms);
+    }
+}
 
 int main() {
+    // The state is restored only after a reboot by the watchdog
+    bool warm = warmboot_check(&state, sizeof(state));
+
     // Init sdio
     stdio_init_all();
-    #ifdef LIB_PICO_STDIO_USB
-    while (!stdio_usb_connected()) {
-        sleep_ms(100);
+    if (!warm) {
+        // Cold boot: wait for the USB host and init the state
+        #ifdef LIB_PICO_STDIO_USB
+        while (!stdio_usb_connected()) {
+            sleep_ms(100);
+        }
+        #endif
+        printf("Watchdog Example\n\n");
+        printf(watchdog_caused_reboot() ? "Rebooted by Watchdog!\n" : "Clean boot\n");
+        memset(&state, 0, sizeof(state));
+        state.maxSleep = 210;
     }
-    #endif
 
-    printf("Watchdog Example\n\n");
-    if (watchdog_caused_reboot()) {
-        printf("Rebooted by Watchdog!\n");
-        sleep_ms(500);
+    taskMain = wdsuper_register("main", 200);
+    taskWorker = wdsuper_register("worker", 500);
+    state.crashed = wdsuper_get_crash(&state.crash);
+
+    // We are operational now
+    uint32_t us = time_us_32();
+    state.boots++;
+    if (warm) {
+        state.warmBoots++;
+        state.warmUs = us;
     } else {
-        printf("Clean boot\n");
+        state.coldUs = us;
     }
+    warmboot_save(&state, sizeof(state));
 
-    // Enable the watchdog with a 100ms timeout
-    watchdog_enable(100, false);
+    // Enable the watchdog with a 100ms timeout,
+    // the supervisor checks the tasks every 20ms
+    wdsuper_init(100, 20);
+    workerLoops = state.workerLoops;
+    multicore_launch_core1(worker);
+    report();
    
-    // Lets play watchdog roulet!
+    // Lets play watchdog roulet (with two players)!
     while (true) {
-        printf (".");
-        sleep_ms(rand() % 101); // 0 to 100ms 
-        watchdog_update();
+        sleep_ms(rand() % (state.maxSleep + 1));
+        wdsuper_checkin(taskMain);
+
+        // Update and save the state before any output: printing can
+        // block and the watchdog may reboot us meanwhile
+        char line[LINE_LEN+1];
+        bool full = false;
+        state.mainLoops++;
+        state.workerLoops = workerLoops;
+        state.line[state.lineLen++] = '.';
+        if (state.lineLen == LINE_LEN) {
+            memcpy(line, state.line, LINE_LEN);
+            line[LINE_LEN] = 0;
+            state.lineLen = 0;
+            full = true;
+        }
+        warmboot_save(&state, sizeof(state));
+
+        if (full) {
+            printf("%s %" PRIu32 "/%" PRIu32 "\n", line, state.mainLoops, state.workerLoops);
+
+            if ((state.mainLoops % (4*LINE_LEN)) == 0) {
+                report();
+            }
+        }
     }
 
     return 0;
@@ -0,0 +1,116 @@
+/**
+ * @file wdsuper.c
+ * @author Daniel Quadros
+ * @brief Watchdog supervisor for multiple tasks
+ *        Each task checks in periodically; a repeating timer feeds the
+ *        hardware watchdog only if all tasks checked in before their
+ *        deadlines. When a task is late, its information is saved in
+ *        the watchdog scratch registers (that survive the reboot) and
+ *        the watchdog is left to expire.
+ *        scratch[0..2] are used, the SDK uses scratch[4..7]
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/watchdog.h"
+#include "wdsuper.h"
+
+// scratch[0] has a magic value, the task id and how late it was (ms)
+#define CRASH_MAGIC     0xDE000000u
+#define MAGIC_MASK      0xFF000000u
+#define TASK_SHIFT      16
+#define TASK_MASK       0x00FF0000u
+#define LATE_MASK       0x0000FFFFu
+
+// Registered tasks
+typedef struct {
+    const char *name;
+    uint32_t deadline_us;
+    volatile uint32_t last;         // time_us_32() of last check in
+    volatile uint32_t pc;           // where the last check in was done
+} TASK;
+
+static TASK tasks[WDSUPER_MAX_TASKS];
+static int nTasks = 0;
+static struct repeating_timer timer;
+static bool expired = false;
+
+// Check the heartbeats, feed the watchdog if all are fresh
+static bool wdsuper_check(struct repeating_timer *t) {
+    if (expired) {
+        return true;    // waiting for the reboot
+    }
+    for (int i = 0; i < nTasks; i++) {
+        // Read the check in before the time, a task in the other core
+        // may check in at any moment
+        uint32_t last = tasks[i].last;
+        uint32_t elapsed = time_us_32() - last;
+        if (elapsed > tasks[i].deadline_us) {
+            // Save information for the post-mortem and
+            // let the watchdog expire
+            uint32_t late = elapsed / 1000;
+            if (late > LATE_MASK) {
+                late = LATE_MASK;
+            }
+            watchdog_hw->scratch[0] = CRASH_MAGIC | (i << TASK_SHIFT) | late;
+            watchdog_hw->scratch[1] = tasks[i].pc;
+            watchdog_hw->scratch[2] = to_ms_since_boot(get_absolute_time());
+            expired = true;
+            return true;
+        }
+    }
+    watchdog_update();
+    return true;
+}
+
+// Start the supervisor
+bool wdsuper_init(uint32_t hw_timeout_ms, uint32_t check_ms) {
+    uint32_t now = time_us_32();
+    for (int i = 0; i < nTasks; i++) {
+        tasks[i].last = now;
+    }
+    watchdog_hw->scratch[0] = 0;
+    watchdog_enable(hw_timeout_ms, true);
+    return add_repeating_timer_ms(check_ms, wdsuper_check, NULL, &timer);
+}
+
+// Register a task
+int wdsuper_register(const char *name, uint32_t deadline_ms) {
+    if (nTasks == WDSUPER_MAX_TASKS) {
+        return -1;
+    }
+    tasks[nTasks].name = name;
+    tasks[nTasks].deadline_us = deadline_ms * 1000;
+    tasks[nTasks].pc = 0;
+    tasks[nTasks].last = time_us_32();
+    return nTasks++;
+}
+
+// Inform that the task is alive
+void __no_inline_not_in_flash_func(wdsuper_checkin)(int task) {
+    tasks[task].pc = (uint32_t) __builtin_return_address(0);
+    tasks[task].last = time_us_32();
+}
+
+// Name of a task
+const char *wdsuper_task_name(int task) {
+    return ((task >= 0) && (task < nTasks)) ? tasks[task].name : "?";
+}
+
+// Check if the last reboot was caused by a task timeout
+bool wdsuper_get_crash(WDSUPER_CRASH *crash) {
+    if (!watchdog_caused_reboot() ||
+        ((watchdog_hw->scratch[0] & MAGIC_MASK) != CRASH_MAGIC)) {
+        return false;
+    }
+    crash->task = (watchdog_hw->scratch[0] & TASK_MASK) >> TASK_SHIFT;
+    crash->pc = watchdog_hw->scratch[1];
+    crash->uptime_ms = watchdog_hw->scratch[2];
+    crash->late_ms = watchdog_hw->scratch[0] & LATE_MASK;
+    return true;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file wdsuper.h
+ * @author Daniel Quadros
+ * @brief Watchdog supervisor for multiple tasks
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _WDSUPER_H
+#define _WDSUPER_H
+
+#include "pico/stdlib.h"
+
+// Maximum number of tasks
+#define WDSUPER_MAX_TASKS   8
+
+// Information about a reboot caused by a task timeout
+typedef struct {
+    int task;                   // task id
+    uint32_t pc;                // where the task last checked in
+    uint32_t uptime_ms;         // time since boot of the timeout
+    uint32_t late_ms;           // time since the last check in
+} WDSUPER_CRASH;
+
+// Start the supervisor: the watchdog is enabled with a timeout
+// of hw_timeout_ms and the heartbeats are checked every check_ms
+// (in a repeating timer, on the core that calls this)
+bool wdsuper_init(uint32_t hw_timeout_ms, uint32_t check_ms);
+
+// Register a task that must check in every deadline_ms
+// Returns the task id or -1 if there is no room
+int wdsuper_register(const char *name, uint32_t deadline_ms);
+
+// Inform that the task is alive (can be called from any core)
+void wdsuper_checkin(int task);
+
+// Name of a task
+const char *wdsuper_task_name(int task);
+
+// Check if the last reboot was caused by a task timeout
+// and get the information saved (call before wdsuper_init)
+bool wdsuper_get_crash(WDSUPER_CRASH *crash);
+
+#endif
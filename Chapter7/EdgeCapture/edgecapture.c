@@ -0,0 +1,250 @@
+/**
+ * @file edgecapture.c
+ * @author Daniel Quadros
+ * @brief Capturing the edges of up to 8 pins with PIO and DMA
+ *        The PIO samples the pins and pushes a record when they change,
+ *        the DMA writes the records in a ring; there are no interrupts
+ *        per edge. Test signals are generated by PWM on the same pins.
+ *        Type 'd' to dump records, that edgevcd.py converts to VCD.
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+
+// Our PIO program:
+#include "edgecap.pio.h"
+
+// Pins to capture: GPIO0 to GPIO7
+#define FIRST_PIN   0
+#define N_PINS      8
+
+// PIO clock divider, the sample rate is clk_sys / (CLOCK_DIV * 7)
+// (17.86MHz with a 125MHz clk_sys)
+#define CLOCK_DIV   1
+
+// Ring for the records (two words each)
+#define RING_BITS   13
+#define RING_WORDS  (1u << RING_BITS)
+static uint32_t ring[RING_WORDS] __attribute__((aligned(RING_WORDS*sizeof(uint32_t))));
+static uint32_t ringCount = RING_WORDS;
+static uint dataChan, ctrlChan;
+static volatile uint32_t laps;
+
+// Records processed
+static uint64_t readTotal;          // words
+static uint64_t now;                // PIO cycles
+static uint32_t lastPins = ~0u;     // as the PIO, so the first record is a change
+static uint32_t nextCycles = EDGECAP_RECORD_CYCLES;
+
+// Statistics for the last second
+static uint32_t records;
+static uint32_t overruns;
+static uint32_t edges[N_PINS];
+
+// Records to dump
+#define DUMP_RECORDS    2000
+static uint32_t dump[DUMP_RECORDS][2];
+static uint32_t dumpPins;           // pins before the first record
+static int nDump = -1;              // -1 = not dumping
+
+// Local routines
+static void init(void);
+static void startPWM(uint gpio, uint32_t freq, uint duty);
+static void dma_irq(void);
+static uint64_t written(void);
+static void processRecords(void);
+static void printStats(uint32_t ms);
+static void printDump(void);
+
+// Main Program
+int main() {
+    stdio_init_all();
+    while (!stdio_usb_connected()) {
+        sleep_ms(100);
+    }
+    printf("\nEdge Capture Example\n");
+    printf("Sampling %d pins at %" PRIu32 " Hz\n", N_PINS,
+           clock_get_hz(clk_sys) / (CLOCK_DIV * EDGECAP_SAMPLE_CYCLES));
+
+    // Test signals
+    startPWM(0, 250000, 50);
+    startPWM(2, 10000, 25);
+    startPWM(4, 1000, 50);
+
+    init();
+    uint32_t statsTime = to_ms_since_boot(get_absolute_time());
+    while (1) {
+        processRecords();
+        if (nDump == DUMP_RECORDS) {
+            printDump();
+            nDump = -1;
+        }
+        int c = getchar_timeout_us(0);
+        if ((c == 'd') && (nDump < 0)) {
+            nDump = 0;
+        }
+        uint32_t ms = to_ms_since_boot(get_absolute_time()) - statsTime;
+        if (ms >= 1000) {
+            printStats(ms);
+            statsTime += ms;
+        }
+    }
+    return 0;
+}
+
+// Generate a square wave with PWM
+static void startPWM(uint gpio, uint32_t freq, uint duty) {
+    uint slice = pwm_gpio_to_slice_num(gpio);
+    uint32_t top = clock_get_hz(clk_sys) / freq;
+    uint div = 1;
+    while ((top / div) > 65536) {
+        div++;
+    }
+    top /= div;
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv_int(&config, div);
+    pwm_config_set_wrap(&config, top - 1);
+    pwm_init(slice, &config, false);
+    pwm_set_gpio_level(gpio, (top * duty) / 100);
+    gpio_set_function(gpio, GPIO_FUNC_PWM);
+    pwm_set_enabled(slice, true);
+}
+
+// Start the capture
+static void init(void) {
+    // Start the PIO
+    PIO pio = pio0;
+    uint offset = edgecap_add_program(pio, N_PINS);
+    uint sm = pio_claim_unused_sm(pio, true);
+
+    // Data channel: writes the records in the ring
+    dataChan = dma_claim_unused_channel(true);
+    ctrlChan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(dataChan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, RING_BITS+2);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, false));
+    channel_config_set_chain_to(&c, ctrlChan);
+    dma_channel_configure(dataChan, &c, ring, &pio->rxf[sm], ringCount, false);
+
+    // Control channel: restarts the data channel by rewriting its count
+    // It interrupts once for each lap around the ring, to count them
+    c = dma_channel_get_default_config(ctrlChan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_chain_to(&c, dataChan);
+    dma_channel_configure(ctrlChan, &c, &dma_hw->ch[dataChan].al1_transfer_count_trig,
+                          &ringCount, 1, false);
+    dma_channel_set_irq0_enabled(ctrlChan, true);
+    irq_set_exclusive_handler(DMA_IRQ_0, dma_irq);
+    irq_set_enabled(DMA_IRQ_0, true);
+    dma_channel_start(dataChan);
+
+    // Start capturing
+    edgecap_program_init(pio, sm, offset, FIRST_PIN, CLOCK_DIV);
+}
+
+// DMA interrupt, the data channel was restarted
+static void dma_irq(void) {
+    dma_hw->ints0 = 1u << ctrlChan;
+    laps++;
+}
+
+// Number of words written by the DMA since the start
+static uint64_t written(void) {
+    uint32_t l, count;
+    do {
+        l = laps;
+        count = dma_hw->ch[dataChan].transfer_count;
+    } while (l != laps);
+    uint64_t total = (uint64_t) l * RING_WORDS + (RING_WORDS - count);
+    if (total < readTotal) {
+        // the channel was restarted, but the interrupt was not handled yet
+        total += RING_WORDS;
+    }
+    return total;
+}
+
+// Process the records in the ring
+static void processRecords(void) {
+    uint64_t total = written();
+    if ((total - readTotal) > RING_WORDS) {
+        // We are too late, the ring was overwritten: skip to the last records
+        overruns++;
+        readTotal = (total - RING_WORDS/2) & ~1ull;
+        if (nDump > 0) {
+            nDump = 0;      // the dump must be continuous, start again
+        }
+    }
+    while ((total - readTotal) >= 2) {
+        uint32_t counter = ring[readTotal & (RING_WORDS-1)];
+        uint32_t pins = ring[(readTotal+1) & (RING_WORDS-1)];
+        readTotal += 2;
+
+        // Save for dumping
+        if ((nDump >= 0) && (nDump < DUMP_RECORDS)) {
+            if (nDump == 0) {
+                dumpPins = lastPins;
+            }
+            dump[nDump][0] = counter;
+            dump[nDump][1] = pins;
+            nDump++;
+        }
+
+        // Time of the sample that found the change
+        uint32_t samples = 0xFFFFFFFF - counter;
+        now += nextCycles + (uint64_t) samples * EDGECAP_SAMPLE_CYCLES;
+        nextCycles = (pins == lastPins) ? EDGECAP_EXPIRED_CYCLES : EDGECAP_RECORD_CYCLES;
+
+        // Count the edges (the first record only has the initial state)
+        uint32_t changed = (lastPins == ~0u) ? 0 : pins ^ lastPins;
+        while (changed) {
+            int pin = __builtin_ctz(changed);
+            changed &= changed - 1;
+            edges[pin]++;
+        }
+        lastPins = pins;
+        records++;
+    }
+}
+
+// Print and clear the statistics
+static void printStats(uint32_t ms) {
+    printf("%" PRIu32 " records/s, %" PRIu32 " overruns, edges/s:",
+           (records * 1000) / ms, overruns);
+    for (int i = 0; i < N_PINS; i++) {
+        printf(" %" PRIu32, (uint32_t) (((uint64_t) edges[i] * 1000) / ms));
+        edges[i] = 0;
+    }
+    printf("\n");
+    records = 0;
+    overruns = 0;
+}
+
+// Dump the records, in the format read by edgevcd.py
+static void printDump(void) {
+    printf("#EDGECAP %" PRIu32 " %d %d %d %d %d %d %02" PRIx32 "\n",
+           clock_get_hz(clk_sys), CLOCK_DIV,
+           N_PINS, FIRST_PIN, EDGECAP_SAMPLE_CYCLES, EDGECAP_RECORD_CYCLES,
+
+           EDGECAP_EXPIRED_CYCLES, dumpPins);
+    for (int i = 0; i < DUMP_RECORDS; i++) {
+        printf("%08" PRIx32 " %02" PRIx32 "\n", dump[i][0], dump[i][1]);
+
+    }
+    printf("#END\n");
+}
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+#
+# edgevcd.py - Edge capture to VCD converter
+# Example for 'Knowing the RP2040' book
+# Copyright (c) 2026, Daniel Quadros
+#
+# Reads the records dumped by edgecapture (a log of the serial output)
+# and writes a VCD file, that can be viewed with GTKWave or PulseView.
+#
+# Usage: edgevcd.py [-n dump] [-o output.vcd] [log.txt]
+#
+# Dump format:
+#   #EDGECAP clk_sys div pins first sample_cycles record_cycles expired_cycles prev_pins
+#   counter pins        (hex, one record per line)
+#   #END
+# The counter is 0xFFFFFFFF minus the samples without change before the
+# record. The time is in PIO cycles (clk_sys / div): a sample without
+# change takes sample_cycles, the sample after a record comes
+# record_cycles later (expired_cycles if the pins did not change).
+#
+
+import argparse
+import sys
+
+
+def read_dumps(f):
+    """Returns a list of (header, records) for the dumps in the log"""
+    dumps = []
+    header = None
+    records = []
+    for line in f:
+        line = line.strip()
+        if line.startswith('#EDGECAP'):
+            header = [int(x) for x in line.split()[1:8]] + [int(line.split()[8], 16)]
+            records = []
+        elif line.startswith('#END'):
+            if header is not None:
+                dumps.append((header, records))
+            header = None
+        elif header is not None and line:
+            counter, pins = line.split()
+            records.append((int(counter, 16), int(pins, 16)))
+    return dumps
+
+
+def to_vcd(header, records, out):
+    """Write the records as a VCD file"""
+    clk_sys, div, npins, first, sample_cyc, record_cyc, expired_cyc, prev = header
+    ps_per_cycle = 1e12 * div / clk_sys
+    ids = [chr(33 + i) for i in range(npins)]
+
+    out.write('$version edgevcd.py $end\n')
+    out.write('$comment clk_sys %d Hz, PIO divider %d, sample every %d cycles $end\n' %
+              (clk_sys, div, sample_cyc))
+    out.write('$timescale 1ps $end\n')
+    out.write('$scope module edgecap $end\n')
+    for i in range(npins):
+        out.write('$var wire 1 %s gpio%d $end\n' % (ids[i], first + i))
+    out.write('$upscope $end\n')
+    out.write('$enddefinitions $end\n')
+
+    # The first record is time zero
+    cycles = 0
+    next_cyc = None
+    last = None
+    for counter, pins in records:
+        if next_cyc is not None:
+            cycles += next_cyc + (0xFFFFFFFF - counter) * sample_cyc
+        next_cyc = expired_cyc if pins == (prev if last is None else last) else record_cyc
+        if last is None:
+            out.write('#0\n$dumpvars\n')
+            for i in range(npins):
+                out.write('%d%s\n' % ((pins >> i) & 1, ids[i]))
+            out.write('$end\n')
+        elif pins != last:
+            out.write('#%d\n' % round(cycles * ps_per_cycle))
+            changed = pins ^ last
+            for i in range(npins):
+                if changed & (1 << i):
+                    out.write('%d%s\n' % ((pins >> i) & 1, ids[i]))
+        last = pins
+    out.write('#%d\n' % round(cycles * ps_per_cycle))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Edge capture to VCD converter')
+    parser.add_argument('-n', '--dump', type=int, default=-1,
+                        help='dump to convert (default: the last one)')
+    parser.add_argument('-o', '--output', help='VCD file (default: stdout)')
+    parser.add_argument('log', nargs='?', help='serial log (default: stdin)')
+    args = parser.parse_args()
+
+    f = open(args.log) if args.log else sys.stdin
+    dumps = read_dumps(f)
+    if not dumps:
+        print('no dumps found', file=sys.stderr)
+        return 1
+    header, records = dumps[args.dump]
+    out = open(args.output, 'w') if args.output else sys.stdout
+    to_vcd(header, records, out)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
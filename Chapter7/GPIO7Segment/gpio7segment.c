@@ -3,6 +3,8 @@
  * @author Daniel Quadros
  * @brief Example of using the GPIO in the RP2040 to drive a
  *        4 digit 7 segment common anode display
+ *        The multiplexing is done by the PIO, fed by DMA: the CPU
+ *        only updates a 4 word frame when the value or brightness changes
  * @version 0.1
  * @date 2022-07-12
  * 
@@ -14,6 +16,12 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/sync.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+
+// Our PIO program:
+#include "sevenseg.pio.h"
  
 // Display connections
 // Segments:  A:6 B:4 C:1 D:2 E:3 F:5 G:0
@@ -24,6 +32,12 @@
 #define DIGIT_2         8
 #define DIGIT_3         9
 #define DIGIT_4         10
+#define FIRST_PIN       0
+
+// PIO clock and cycles for each digit (2ms, 125Hz refresh)
+#define PIO_FREQ        250000
+#define DIGIT_CYCLES    500
+#define MAX_ON          (DIGIT_CYCLES - SEVENSEG_OVERHEAD)
  
 // Digit selection GPIOs
 int digit[] = { DIGIT_1, DIGIT_2, DIGIT_3, DIGIT_4 };
@@ -42,19 +56,26 @@ int segments[] = { // AFB EDCG   0 = on, 1 = off
     0x08         // 000 1000
  };
  
-// Timer to update the display
-struct repeating_timer timer;
+// Frame sent continuously to the PIO by the DMA, one word per digit
+// Must be aligned to its size for the DMA read ring
+static uint32_t frame[4] __attribute__((aligned(16)));
+static uint32_t frameLen = 4;
  
 // Value to show on display
 volatile int value[4];
  
+// Brightness (0 to 255) of each digit and of the whole display
+static uint8_t brightness[4] = { 64, 128, 192, 255 };
+static int globalBrightness = 255;
+ 
 // Local routines
 static void init(void);
-static bool updateDisplay(struct repeating_timer *t);
+static void updateDisplay(void);
  
 // Main Program
 int main() {
     init();
+    int step = 16;
     while (1) {
         // Increment value
         int i = 3;
@@ -65,8 +86,16 @@ int main() {
         if (i >= 0) {
             value[i]++;
         }
-        // Wait 1 second
-        sleep_ms(1000);
+        // Fade the display up and down, 10 steps per count
+        // (255 to 15 takes 1.5 seconds)
+        for (int n = 0; n < 10; n++) {
+            if ((globalBrightness + step > 255) || (globalBrightness + step < 15)) {
+                step = -step;
+            }
+            globalBrightness += step;
+            updateDisplay();
+            sleep_ms(100);
+        }
     }
     return 0;
 }
@@ -75,28 +104,55 @@ int main() {
 void init() {
     int i;
  
+    // Build the frame for the initial value
+    updateDisplay();
+
     // GPIO init
-    gpio_init_mask (SEGMENTS_MASK | DIGITS_MASK);
-    gpio_set_dir_masked (SEGMENTS_MASK | DIGITS_MASK, SEGMENTS_MASK | DIGITS_MASK);
     for (i = 0; i < 4; i++) {
         gpio_set_drive_strength (digit[i], GPIO_DRIVE_STRENGTH_12MA);
     }
-     
-    // Update a digit every 5 miliseconds
-    add_repeating_timer_ms(5, updateDisplay, NULL, &timer);
+
+    // Start the PIO, with 4us resolution for the on and off times
+    PIO pio = pio0;
+    uint offset = pio_add_program(pio, &sevenseg_program);
+    uint sm = pio_claim_unused_sm(pio, true);
+    sevenseg_program_init(pio, sm, offset, FIRST_PIN, PIO_FREQ);
+
+    // Data channel: sends the frame to the PIO, the read address
+    // wraps around the frame (ring)
+    int data_chan = dma_claim_unused_channel(true);
+    int ctrl_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(data_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_ring(&c, false, 4);      // 16 bytes
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    channel_config_set_chain_to(&c, ctrl_chan);
+    dma_channel_configure(data_chan, &c, &pio->txf[sm], frame, frameLen, false);
+
+    // Control channel: restarts the data channel by rewriting its count
+    c = dma_channel_get_default_config(ctrl_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_chain_to(&c, data_chan);
+    dma_channel_configure(ctrl_chan, &c, &dma_hw->ch[data_chan].al1_transfer_count_trig,
+                          &frameLen, 1, false);
+
+    // From now on the display is refreshed without the CPU
+    dma_channel_start(data_chan);
 }
  
-// Update Display
-bool updateDisplay(struct repeating_timer *t) {
-    static int nDig = 3;
- 
-    gpio_put (digit[nDig], false); // turn off previous digit
-    nDig = (nDig + 1) & 3;  // moves on to next digit
-     
-    // set up segments
-    gpio_put_masked (SEGMENTS_MASK, segments[value[nDig]]); 
-     
-    gpio_put (digit[nDig], true); // turns on current digit
- 
-    return true;    // keep calling this routine
-}
\ No newline at end of file
+// Update the frame with the current value and brightness
+// Only the RAM is written, the DMA will pick the new values
+void updateDisplay() {
+    for (int nDig = 0; nDig < 4; nDig++) {
+        uint32_t on = (MAX_ON * brightness[nDig] * globalBrightness) / (255 * 255);
+        uint32_t pins = segments[value[nDig]];
+        if (on > 0) {
+            pins |= 1u << digit[nDig];
+        }
+        frame[nDig] = sevenseg_word(pins, on, MAX_ON - on);
+    }
+}
@@ -11,11 +11,12 @@
 
 #include <stdio.h>
 #include <time.h>
+#include <inttypes.h>
 
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
- 
- #define millis() to_ms_since_boot(get_absolute_time())
+#include "hardware/timer.h"
+#include "spscring.h"
  
 //  A button is connected betweem this pin and ground
 #define BUTTON_PIN 16
@@ -23,30 +24,36 @@
 // Structure to represent a GPIO event
 typedef struct {
 	uint32_t event_mask;
-	uint32_t event_time;
+	uint32_t event_time;	// microseconds (low word of the timer)
 } GPIO_EVENT;
 
-// GPIO event queue
-#define MAX_EVENTS 100
-static GPIO_EVENT event_queue[MAX_EVENTS+1];
-static volatile int event_in = 0;  // where to place next event
-static int event_out = 0;  // where to take out next event
+// GPIO event queue (128 events)
+SPSC_RING_DEFINE(event_queue, GPIO_EVENT, 7);
 
 
 // Interrupt  handler
 void gpio_interrupt (uint gpio, uint32_t events) {
 	// set up the event information
-	event_queue[event_in].event_mask = events;
-	event_queue[event_in].event_time = millis();
-	// check if there is space for it in the queue
-	int aux = event_in + 1;
-	if (aux > MAX_EVENTS) {
-		aux = 0;
-	}
-	if (aux != event_out) {
-		// Ok, advance the input index
-		event_in = aux;
+	GPIO_EVENT ev;
+	ev.event_time = timer_hw->timerawl;
+	ev.event_mask = events;
+	// put it in the queue (it is dropped if the queue is full)
+	spsc_put(&event_queue, &ev);
+}
+
+
+// Measure the time to put and get events
+static void benchmark(void) {
+	const int N = 10000;
+	SPSC_RING_DEFINE(ring, GPIO_EVENT, 7);
+	GPIO_EVENT ev = { 0, 0 };
+	uint32_t start = time_us_32();
+	for (int i = 0; i < N; i++) {
+		spsc_put(&ring, &ev);
+		spsc_get(&ring, &ev);
 	}
+	uint32_t elapsed = time_us_32() - start;
+	printf ("Queue: %" PRIu32 " ns per put and get\n", (elapsed * 1000) / N);
 }
 
 
@@ -55,6 +62,10 @@ int main() {
 	
     // Init stdio0
     stdio_init_all();
+    while (!stdio_usb_connected()) {
+        sleep_ms(100);
+    }
+    benchmark();
 
     // Init the button pin
     gpio_init(BUTTON_PIN);
@@ -68,22 +79,23 @@ int main() {
 	irq_set_enabled(IO_IRQ_BANK0, true);
 
     // main loop
+	uint32_t drops = 0;
     while (1) {
 		// Print out recorded events
-		while (event_in != event_out) {
+		GPIO_EVENT ev;
+		while (spsc_get(&event_queue, &ev)) {
 			// print an event
-			printf ("%7d %s %s\n",  event_queue[event_out].event_time,
-				(event_queue[event_out].event_mask & GPIO_IRQ_EDGE_FALL) ?
-					"PRESS" : "     ",
-				(event_queue[event_out].event_mask & GPIO_IRQ_EDGE_RISE) ?
-					"RELEASE" : ""
+			printf ("%10" PRIu32 " %s %s\n",  ev.event_time,
+				(ev.event_mask & GPIO_IRQ_EDGE_FALL) ? "PRESS" : "     ",
+				(ev.event_mask & GPIO_IRQ_EDGE_RISE) ? "RELEASE" : ""
 			);
-			// remove it from the queue
-			int aux = event_out;
-			if (++aux > MAX_EVENTS) {
-				aux = 0;
-			}
-			event_out = aux;
+		}
+		// report lost events
+		if (event_queue.drops != drops) {
+			drops = event_queue.drops;
+			printf ("%" PRIu32 " events lost (max queue use %" PRIu32 ")\n",
+				drops, event_queue.highWater);
+
 		}
         sleep_ms(10);
     }
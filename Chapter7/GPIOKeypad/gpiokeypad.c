@@ -2,7 +2,11 @@
  * @file gpio7segment.c
  * @author Daniel Quadros
  * @brief Example of using the GPIO in the RP2040 to
- *        read a 4x4 matrix keypad
+ *        read a matrix keypad (up to 16x8, with n-key rollover)
+ *        With SCAN_PIO the keypad is scanned by the PIO and the
+ *        scans are written in a ring by DMA, without the CPU
+ *        With IDLE_MODE the scan stops when no key is pressed, until
+ *        a column interrupt
  * @version 0.1
  * @date 2022-07-14
  * 
@@ -11,38 +15,119 @@
  */
 
 #include <stdio.h>
+#include <inttypes.h>
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/sync.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "vdebounce.h"
+#include "spscring.h"
+
+// Our PIO program:
+#include "keyscan.pio.h"
+
+// Scan method: 1 = PIO and DMA, 0 = timer interrupt
+#ifndef SCAN_PIO
+#define SCAN_PIO 1
+#endif
+
+// Idle mode: after IDLE_MS with no keys pressed the scan is stopped, all
+// rows are driven high and a rising edge in any column restarts it
+#ifndef IDLE_MODE
+#define IDLE_MODE 1
+#endif
+#define IDLE_MS   2000
 
 // GPIOs
 // Rows:    GPIO10 to GPIO13
 // Columns: GPIO18 to GPIO21
+// nRows can be 4, 8 or 16 and nColumns up to 8
+// These options can also be defined in the build (the host test does)
+#ifndef nRows
 #define nRows    4
 #define nColumns 4
+#endif
+#if nRows == 16
+// 16 rows don't fit before the columns, use GPIO0 to GPIO15 for the rows
+// and GPIO16 up for the columns (GPIO23 is not available in the Pico
+// board, so there it is up to 16x7)
+static const int firstRow = 0;
+static const int firstColumn = 16;
+#else
 static const int firstRow = 10;
 static const int firstColumn = 18;
+#endif
+
+#if (nRows != 4) && (nRows != 8) && (nRows != 16)
+#error "nRows must be 4, 8 or 16"
+#endif
+#if nColumns > 8
+#error "nColumns must be 8 or less"
+#endif
+
+// Scans have a byte for each row (the same format as the PIO),
+// 4 rows per word
+#define SCAN_WORDS  (nRows/4)
 
 // GPIO masks
 static uint32_t rowMask;
 static uint32_t columnMask;
 
+#if SCAN_PIO
+
+// Scans per second and the ring the DMA writes them
+#define SCAN_HZ         1000
+#define SCAN_PERIOD_US  (1000000 / SCAN_HZ)
+#define RING_BITS       6
+#define RING_WORDS      (1u << RING_BITS)
+static uint32_t ring[RING_WORDS] __attribute__((aligned(RING_WORDS*sizeof(uint32_t))));
+static uint32_t ringCount = RING_WORDS;
+static PIO pio = pio0;
+static uint sm;
+static uint offset;
+static uint dataChan;
+static uint32_t readPos;
+
+#else
+
 // Timer to scan the keypad
 static struct repeating_timer timer;
- 
-// Columns readings
-static const int DEBOUNCE = 5;
-static uint32_t kp_debounced[nRows];
-static uint32_t kp_debouncing[nRows];
-static int debunceCounter[nRows];
-
-// Keys queue
-#define sizeQueue 5
-static int inQueue = 0, outQueue = 0;
-static char queue[sizeQueue+1];
-
-// Kepad decoding
-static int decod[nRows][nColumns] = {
+#define SCAN_PERIOD_US  10000
+
+#endif
+
+// Scans readings
+static uint32_t scanMask;
+static VDEBOUNCE kp[SCAN_WORDS];
+static uint32_t ghostScans;
+
+#if IDLE_MODE
+// Idle control
+static bool idle;
+static volatile bool wakeup;
+static volatile uint32_t wakeTime;
+static volatile uint32_t lastActive;
+static bool firstKey;
+static uint32_t idleStart;
+#endif
+
+// Key events
+#define EV_PRESSED  0x01
+#define EV_FIRST    0x02    // first key after waking up
+typedef struct {
+    uint32_t time;          // estimated key down/up time (us)
+    uint8_t row;
+    uint8_t column;
+    uint8_t flags;
+} KEY_EVENT;
+
+// Events queue (32 events)
+SPSC_RING_DEFINE(queue, KEY_EVENT, 5);
+
+// Kepad decoding (keys without a character are shown by row and column)
+static const char decod[nRows][nColumns] = {
     {  '1', '2', '3', 'A' },
     {  '*', '0', '#', 'D' },
     {  '7', '8', '9', 'C' },
@@ -52,8 +137,26 @@ static int decod[nRows][nColumns] = {
 // Local routines
 static uint32_t buildMask(int first, int n);
 static void init(void);
+#if SCAN_PIO
+static uint32_t processScans(void);
+#else
 static bool scanKeypad(struct repeating_timer *t);
-static int readKey(void);
+#endif
+static bool ghostFilter(uint32_t *sample, const VDEBOUNCE *db);
+static void debounceScan(const uint32_t *scan, uint32_t when);
+static void putEvent(int row, int column, bool pressed, uint32_t time);
+static void benchmark(void);
+static bool readEvent(KEY_EVENT *ev);
+static void printStats(void);
+static const char *keyName(const KEY_EVENT *ev, char *name);
+#if IDLE_MODE
+static void startScan(void);
+static void stopScan(void);
+static void columnIrq(uint gpio, uint32_t events);
+static void setColumnIrq(bool enabled);
+static void enterIdle(void);
+static void checkIdle(void);
+#endif
  
 // Main Program
 int main() {
@@ -66,12 +169,45 @@ int main() {
     #endif
 
     printf("\nKeypad GPIO Input Example\n");
+    benchmark();
     init();
+    #if SCAN_PIO
+    printf("Scanning by PIO at %dHz\n", SCAN_HZ);
+    #else
+    printf("Scanning by timer every 10ms\n");
+    #endif
+    uint32_t statsTime = time_us_32();
     while (1) {
-        int key = readKey();
-        if (key != -1) {
-            printf ("Key = %c\n", key);
+        KEY_EVENT ev;
+        while (readEvent(&ev)) {
+            char name[8];
+            keyName(&ev, name);
+            if (ev.flags & EV_PRESSED) {
+                uint32_t latency = time_us_32() - ev.time;
+                printf ("Key %s down (latency %" PRIu32 ".%" PRIu32 " ms%s)\n", name,
+
+                        latency / 1000, (latency % 1000) / 100,
+                        (ev.flags & EV_FIRST) ? ", first after idle" : "");
+            } else {
+                printf ("Key %s up\n", name);
+            }
         }
+        if ((time_us_32() - statsTime) > 10000000) {
+            printStats();
+            statsTime = time_us_32();
+        }
+        #if IDLE_MODE
+        checkIdle();
+        if (idle) {
+            // Wait for an interrupt (USB or column)
+            uint32_t save = save_and_disable_interrupts();
+            if (!wakeup) {
+                __wfi();
+            }
+            restore_interrupts(save);
+            continue;
+        }
+        #endif
         sleep_ms(1);
     }
     return 0;
@@ -100,81 +236,315 @@ static void init() {
         gpio_pull_down(firstColumn+i);
     }
 
+    // Columns of each row in the scan word
+    for (int i = 0; i < 4; i++) {
+        scanMask |= ((1u << nColumns) - 1) << (8*i);
+    }
+    for (int i = 0; i < SCAN_WORDS; i++) {
+        vdebounce_init(&kp[i], 0);
+    }
+
+    #if SCAN_PIO
+    // Start the PIO
+    offset = pio_add_program(pio, &keyscan_program);
+    sm = pio_claim_unused_sm(pio, true);
+    keyscan_program_init(pio, sm, offset, firstRow, nRows, firstColumn, SCAN_HZ);
+
+    // Data channel: writes the scans in the ring
+    dataChan = dma_claim_unused_channel(true);
+    int ctrlChan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(dataChan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, RING_BITS+2);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, false));
+    channel_config_set_chain_to(&c, ctrlChan);
+    dma_channel_configure(dataChan, &c, ring, &pio->rxf[sm], ringCount, false);
+
+    // Control channel: restarts the data channel by rewriting its count
+    c = dma_channel_get_default_config(ctrlChan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_chain_to(&c, dataChan);
+    dma_channel_configure(ctrlChan, &c, &dma_hw->ch[dataChan].al1_transfer_count_trig,
+                          &ringCount, 1, false);
+    dma_channel_start(dataChan);
+    #else
+    // Scan keypad every 10 miliseconds
+    add_repeating_timer_ms(10, scanKeypad, NULL, &timer);
+    #endif
+
+    #if IDLE_MODE
+    // Set the callback for the column interrupts (they are enabled when idle)
+    gpio_set_irq_enabled_with_callback(firstColumn, GPIO_IRQ_EDGE_RISE, false, columnIrq);
+    lastActive = time_us_32();
+    #endif
+}
+
+#if IDLE_MODE
+
+// Start scanning the keypad
+static void startScan(void) {
+    #if SCAN_PIO
+    // Restart the program at the start of a scan
+    pio_sm_exec(pio, sm, pio_encode_jmp(offset + keyscan_wrap_target));
+    pio_sm_set_enabled(pio, sm, true);
+    #else
     // Scan keypad every 10 miliseconds
     add_repeating_timer_ms(10, scanKeypad, NULL, &timer);
+    #endif
+}
+
+// Stop scanning the keypad, with all rows high
+static void stopScan(void) {
+    #if SCAN_PIO
+    // Process the complete scans and discard a partial one
+    pio_sm_set_enabled(pio, sm, false);
+    while (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+        tight_loop_contents();
+    }
+    busy_wait_us_32(1);     // let the DMA finish the last write
+    readPos = processScans();
+    pio_sm_restart(pio, sm);
+    // Set the rows using the PIO
+    pio_sm_exec(pio, sm, pio_encode_mov_not(pio_pins, pio_null));
+    #else
+    cancel_repeating_timer(&timer);
+    gpio_put_masked (rowMask, rowMask);
+    #endif
+}
+
+#endif
+
+#if SCAN_PIO
+
+// Debounce the scans written by the DMA since the last call
+// The ring holds RING_WORDS/SCAN_WORDS scans, this must be called
+// more often than that
+// Returns the ring position after the last word written
+static uint32_t processScans(void) {
+    uint32_t writePos = (dma_hw->ch[dataChan].write_addr - (uint32_t) ring) / sizeof(uint32_t);
+    writePos &= RING_WORDS - 1;
+    uint32_t pending = ((writePos - readPos) & (RING_WORDS - 1)) / SCAN_WORDS;
+    uint32_t now = time_us_32();
+
+    // The last scan was done (about) now, the previous ones one
+    // period before each
+    while (pending) {
+        uint32_t scan[SCAN_WORDS];
+        pending--;
+        for (int i = 0; i < SCAN_WORDS; i++) {
+            scan[i] = ring[readPos];
+            readPos = (readPos + 1) & (RING_WORDS - 1);
+        }
+        debounceScan(scan, now - pending * SCAN_PERIOD_US);
+    }
+    return writePos;
 }
+
+#else
  
-// Scan the current row of the keypad
+// Scan all rows of the keypad
 static bool scanKeypad(struct repeating_timer *t) {
-    static int curRow = firstRow;
-    static int countRow = 0;
-
-    // Turn on current row
-    gpio_put_masked (rowMask, 1 << curRow);
-
-    // Read columns
-    uint32_t current = gpio_get_all() & columnMask;
-
-    // Debounce
-    if (current != kp_debouncing[countRow]) {
-        // reading changed, start debouncing again
-        kp_debouncing[countRow] = current;
-        debunceCounter[countRow] = 0;
-    } else if (debunceCounter[countRow] <= DEBOUNCE) {
-        if (debunceCounter[countRow] == DEBOUNCE) {
-            // consider value stable
-            if (kp_debounced[countRow] != current) {
-                // Find key pressed
-                uint32_t dif = kp_debounced[countRow] ^ current;
-                int i = 0;
-                while (i < nColumns) {
-                    uint32_t mask = 1 << (i+firstColumn);
-                    if (((dif & mask) != 0) && ((current & mask) != 0)) {
-                        // there is a change and key is pressed
-                        break;
-                    }
-                    i++;
-                }
-                if (i < nColumns) {
-                    int key = decod[countRow][i];
-                    int aux = inQueue+1;
-                    if (aux > sizeQueue) {
-                        aux = 0;
-                    }
-                    if (aux != outQueue) {
-                        queue[inQueue] = key;
-                        inQueue = aux;
-                    } else {
-                        // queue is full, ignore key
-                    }
+    uint32_t scan[SCAN_WORDS] = { 0 };
+    for (int row = 0; row < nRows; row++) {
+        // Turn on the row and read the columns
+        gpio_put_masked (rowMask, 1 << (firstRow+row));
+        busy_wait_us_32(10);
+        uint32_t current = gpio_get_all() & columnMask;
+        scan[row/4] |= (current >> firstColumn) << (8*(row%4));
+    }
+    gpio_put_masked (rowMask, 0);
+
+    debounceScan(scan, time_us_32());
+    return true; // keep executing
+}
+
+#endif
+
+// Ghost detection
+// Without diodes, when three keys in the corners of a rectangle are
+// pressed the fourth one is also read as pressed. A row with more than
+// one key that shares a column with another row may have ghosts, the
+// readings of these rows are replaced by the debounced state
+// Returns true if a ghost was possible
+static bool ghostFilter(uint32_t *sample, const VDEBOUNCE *db) {
+    uint8_t *rows = (uint8_t *) sample;     // little endian: byte n is row n
+    uint16_t ghosts = 0;
+    for (int r = 0; r < nRows; r++) {
+        uint8_t cols = rows[r];
+        if (cols & (cols - 1)) {
+            for (int other = 0; other < nRows; other++) {
+                if ((other != r) && (rows[other] & cols)) {
+                    ghosts |= 1u << r;
+                    break;
                 }
-                // uodate debounced status
-                kp_debounced[countRow] = current;
             }
         }
-        debunceCounter[countRow]++;
     }
+    for (int r = 0; r < nRows; r++) {
+        if (ghosts & (1u << r)) {
+            rows[r] = (uint8_t) (db[r/4].state >> (8*(r%4)));
+        }
+    }
+    return ghosts != 0;
+}
+
+// Debounce a scan taken at 'when' and queue the keys pressed and released
+// Without bounces, the change was first seen VDEBOUNCE_SAMPLES-1 scans before
+// and happened (in average) half a scan before that
+static void debounceScan(const uint32_t *scan, uint32_t when) {
+    uint32_t sample[SCAN_WORDS];
+    bool active = false;
+    for (int i = 0; i < SCAN_WORDS; i++) {
+        sample[i] = scan[i] & scanMask;
+        active |= sample[i] != 0;
+    }
+    if (ghostFilter(sample, kp)) {
+        ghostScans++;
+    }
+    uint32_t time = when - (VDEBOUNCE_SAMPLES-1) * SCAN_PERIOD_US - SCAN_PERIOD_US/2;
+    for (int i = 0; i < SCAN_WORDS; i++) {
+        uint32_t changed = vdebounce_update(&kp[i], sample[i]);
+        while (changed) {
+            int bit = vdebounce_next(&changed);
+            putEvent(4*i + bit/8, bit%8, (kp[i].state >> bit) & 1, time);
+        }
+        active |= kp[i].state != 0;
+    }
+    #if IDLE_MODE
+    if (active) {
+        lastActive = when;
+    }
+    #endif
+}
+
+// Put an event in the queue (called only by the scan)
+// The first key after waking up uses the time of the column interrupt
+static void putEvent(int row, int column, bool pressed, uint32_t time) {
+    KEY_EVENT ev;
+    ev.row = row;
+    ev.column = column;
+    ev.flags = pressed ? EV_PRESSED : 0;
+    #if IDLE_MODE
+    if (pressed && firstKey) {
+        ev.flags |= EV_FIRST;
+        time = wakeTime;
+        firstKey = false;
+    }
+    #endif
+    ev.time = time;
+    spsc_put(&queue, &ev);
+}
 
-    // Move on to next row
-    if (++countRow == nRows) {
-        countRow = 0;
-        curRow = firstRow;
+// Measure the cycles to debounce a scan (with no keys changing)
+static void benchmark(void) {
+    const int N = 10000;
+    VDEBOUNCE d[SCAN_WORDS];
+    volatile uint32_t sample = 0;
+    uint32_t changed = 0;
+    for (int i = 0; i < SCAN_WORDS; i++) {
+        vdebounce_init(&d[i], 0);
+    }
+    uint32_t start = time_us_32();
+    for (int n = 0; n < N; n++) {
+        uint32_t scan[SCAN_WORDS];
+        for (int i = 0; i < SCAN_WORDS; i++) {
+            scan[i] = sample;
+        }
+        ghostFilter(scan, d);
+        for (int i = 0; i < SCAN_WORDS; i++) {
+            changed |= vdebounce_update(&d[i], scan[i]);
+        }
+    }
+    uint32_t elapsed = time_us_32() - start;
+    float cycles = (float) elapsed * (clock_get_hz(clk_sys) / 1000000) / N;
+    printf("Debounce: %.1f cycles per scan (%" PRIu32 ")\n", cycles, changed);
+
+}
+
+// Get an event from the queue, returns false if queue empty
+static bool readEvent(KEY_EVENT *ev) {
+    #if SCAN_PIO
+    processScans();
+    #endif
+    return spsc_get(&queue, ev);
+}
+
+// Name of the key of an event: its character or row and column
+static const char *keyName(const KEY_EVENT *ev, char *name) {
+    char key = decod[ev->row][ev->column];
+    if (key != 0) {
+        name[0] = key;
+        name[1] = 0;
     } else {
-        curRow++;
+        sprintf(name, "R%uC%u", ev->row, ev->column);
     }
+    return name;
+}
 
-    return true; // keep executing
+// Print the queue and ghost statistics
+static void printStats(void) {
+    printf("Events %" PRIu32 ", lost %" PRIu32 ", max queue use %" PRIu32 "/%" PRIu32
+           ", scans with ghosts %" PRIu32 "\n",
+
+           spsc_total(&queue), queue.drops, queue.highWater, queue.mask + 1, ghostScans);
 }
 
+#if IDLE_MODE
+
+// Column interrupt, a key was pressed while idle
+static void columnIrq(uint gpio, uint32_t events) {
+    if (!wakeup) {
+        wakeTime = time_us_32();
+        wakeup = true;
+    }
+    setColumnIrq(false);
+}
+
+// Enable or disable the rising edge interrupt of the columns
+static void setColumnIrq(bool enabled) {
+    for (int i = 0; i < nColumns; i++) {
+        gpio_acknowledge_irq(firstColumn+i, GPIO_IRQ_EDGE_RISE);
+        gpio_set_irq_enabled(firstColumn+i, GPIO_IRQ_EDGE_RISE, enabled);
+    }
+}
+
+// Stop scanning and wait for a key
+static void enterIdle(void) {
+    stopScan();
+    idle = true;
+    firstKey = false;
+    idleStart = time_us_32();
+    wakeup = false;
+    setColumnIrq(true);
+    busy_wait_us_32(10);
+    if (gpio_get_all() & columnMask) {
+        // key pressed before the interrupt was armed
+        setColumnIrq(false);
+        wakeTime = time_us_32();
+        wakeup = true;
+    }
+}
+
+// Go idle after IDLE_MS without keys, wake up after a column interrupt
+static void checkIdle(void) {
+    if (idle) {
+        if (wakeup) {
+            wakeup = false;
+            idle = false;
+            firstKey = true;
+            lastActive = wakeTime;
+            startScan();
+            printf("Awake after %" PRIu32 " ms idle\n", (wakeTime - idleStart) / 1000);
 
-// Read a key from the key queue, returns -1 if queue empty
-static int readKey(void) {
-    int key = -1;
-    if (inQueue != outQueue) {
-        key = queue[outQueue];
-        if (outQueue++ == sizeQueue) {
-            outQueue = 0;
         }
+    } else if ((time_us_32() - lastActive) > IDLE_MS*1000) {
+        printf("Idle\n");
+        enterIdle();
     }
-    return key;
-}
\ No newline at end of file
+}
+
+#endif
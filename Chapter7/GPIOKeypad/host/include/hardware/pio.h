@@ -0,0 +1,2 @@
+// Host version of the SDK header, see keypademu.h
+#include "keypademu.h"
@@ -0,0 +1 @@
+// Host version: the PIO is not used (SCAN_PIO is 0)
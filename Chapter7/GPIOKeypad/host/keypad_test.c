@@ -0,0 +1,248 @@
+/**
+ * @file keypad_test.c
+ * @author Daniel Quadros
+ * @brief Host test of the keypad scan, ghost filter and debounce
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ * gpiokeypad.c is included (with its main renamed) to reach its static
+ * routines; it is built with the timer scan and without the idle mode.
+ * The scans read an emulated matrix without diodes. Random chords of
+ * 1 to 6 keys are pressed (some with bounces) and then released:
+ * - chords without three corners of a rectangle must be reported exactly
+ *   and with the press time estimated within half a scan period
+ * - the other chords must not report any key that was not pressed
+ * - there must be no repeated events and no key left pressed
+ * At the end a burst of events without reading the queue checks the
+ * lost events count.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#define main keypad_main
+#include "gpiokeypad.c"
+#undef main
+
+// Test parameters
+#define N_CHORDS        20000
+#define MAX_KEYS        6
+#define MAX_BOUNCES     3       // bounces are pairs of toggles, one per scan
+#define HOLD_SCANS      (2*MAX_BOUNCES + VDEBOUNCE_SAMPLES + 2)
+#define SCAN_TIME_US    (10 * nRows)
+
+static bool physical[nRows][nColumns];  // emulated key contacts
+static bool inChord[nRows][nColumns];   // keys pressed in the current chord
+static bool reported[nRows][nColumns];  // state from the events
+static uint32_t pressTime[nRows][nColumns];
+static int bounces[nRows][nColumns];    // toggles left
+static bool timeCheck;
+static uint32_t now;                    // start of the next scan
+static long errors;
+static long timeChecks;
+static int32_t minErr, maxErr;
+
+static void error(const char *msg, int row, int column) {
+    if (errors < 20) {
+        printf("Error: %s (row %d column %d)\n", msg, row, column);
+    }
+    errors++;
+}
+
+// Change a key, at a random time between the scans
+static void setKey(int row, int column, bool pressed, int nBounces) {
+    uint32_t at = now - SCAN_PERIOD_US + SCAN_TIME_US + 1 +
+                  rand() % (SCAN_PERIOD_US - SCAN_TIME_US - 1);
+    physical[row][column] = pressed;
+    bounces[row][column] = 2 * nBounces;
+    pressTime[row][column] = at;
+    keypademu_set_key(row, column, pressed);
+}
+
+// Check the events in the queue
+static void drain(void) {
+    KEY_EVENT ev;
+    while (readEvent(&ev)) {
+        int r = ev.row;
+        int c = ev.column;
+        bool pressed = (ev.flags & EV_PRESSED) != 0;
+        if ((r >= nRows) || (c >= nColumns)) {
+            error("event for a key outside the matrix", r, c);
+            continue;
+        }
+        if (pressed == reported[r][c]) {
+            error("repeated event", r, c);
+        }
+        reported[r][c] = pressed;
+        if (pressed && !inChord[r][c]) {
+            error("key not pressed reported", r, c);
+        }
+        if (pressed && timeCheck) {
+            int32_t err = (int32_t) (ev.time - pressTime[r][c]);
+            if (err < minErr) {
+                minErr = err;
+            }
+            if (err > maxErr) {
+                maxErr = err;
+            }
+            if ((err < -SCAN_PERIOD_US/2) || (err > SCAN_PERIOD_US/2)) {
+                error("press time off by more than half a scan", r, c);
+            }
+            timeChecks++;
+        }
+    }
+}
+
+// Do 'n' scans, the keys bounce between them
+static void step(int n) {
+    while (n--) {
+        keypademu_advance(now - time_us_32());
+        scanKeypad(NULL);
+        now += SCAN_PERIOD_US;
+        for (int r = 0; r < nRows; r++) {
+            for (int c = 0; c < nColumns; c++) {
+                if (bounces[r][c]) {
+                    bounces[r][c]--;
+                    keypademu_set_key(r, c, (bounces[r][c] & 1) ? !physical[r][c] : physical[r][c]);
+                }
+            }
+        }
+        drain();
+    }
+}
+
+// A chord is ambiguous if it has three corners of a rectangle
+static bool ambiguous(void) {
+    for (int a = 0; a < nRows; a++) {
+        for (int b = a+1; b < nRows; b++) {
+            for (int c = 0; c < nColumns; c++) {
+                for (int d = c+1; d < nColumns; d++) {
+                    if (inChord[a][c] + inChord[a][d] + inChord[b][c] + inChord[b][d] >= 3) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Press and release a random chord
+static void testChord(long *nAmbiguous, long *heldBack) {
+    int keys[MAX_KEYS][2];
+    int n = 1 + rand() % MAX_KEYS;
+    bool bouncing = (rand() % 4) == 0;
+
+    memset(inChord, 0, sizeof(inChord));
+    for (int k = 0; k < n; k++) {
+        keys[k][0] = rand() % nRows;
+        keys[k][1] = rand() % nColumns;
+        inChord[keys[k][0]][keys[k][1]] = true;
+    }
+    bool amb = ambiguous();
+    timeCheck = !amb && !bouncing;
+
+    for (int k = 0; k < n; k++) {
+        if (!physical[keys[k][0]][keys[k][1]]) {
+            setKey(keys[k][0], keys[k][1], true, bouncing ? rand() % (MAX_BOUNCES+1) : 0);
+        }
+        step(rand() % 2);
+    }
+    step(HOLD_SCANS);
+    for (int r = 0; r < nRows; r++) {
+        for (int c = 0; c < nColumns; c++) {
+            if (reported[r][c] != inChord[r][c]) {
+                if (amb) {
+                    (*heldBack)++;
+                } else {
+                    error("chord not reported exactly", r, c);
+                }
+            }
+        }
+    }
+    *nAmbiguous += amb;
+
+    timeCheck = false;
+    for (int k = 0; k < n; k++) {
+        if (physical[keys[k][0]][keys[k][1]]) {
+            setKey(keys[k][0], keys[k][1], false, bouncing ? rand() % (MAX_BOUNCES+1) : 0);
+        }
+        step(rand() % 2);
+    }
+    step(HOLD_SCANS);
+    for (int r = 0; r < nRows; r++) {
+        for (int c = 0; c < nColumns; c++) {
+            if (reported[r][c]) {
+                error("key stuck after the release", r, c);
+            }
+        }
+    }
+}
+
+// Events without reading the queue: all but 32 are lost
+static void testBurst(void) {
+    const int nEvents = 40;
+    uint32_t drops = queue.drops;
+    memset(inChord, 0, sizeof(inChord));
+    inChord[0][0] = true;
+    for (int i = 0; i < nEvents; i++) {
+        keypademu_set_key(0, 0, (i & 1) == 0);
+        for (int n = 0; n < HOLD_SCANS; n++) {
+            keypademu_advance(now - time_us_32());
+            scanKeypad(NULL);
+            now += SCAN_PERIOD_US;
+        }
+    }
+    uint32_t size = queue.mask + 1;
+    printf("Burst of %d events: %lu queued, %lu lost, max use %lu\n", nEvents,
+           (unsigned long) spsc_count(&queue), (unsigned long) (queue.drops - drops),
+           (unsigned long) queue.highWater);
+    if ((spsc_count(&queue) != size) || (queue.drops - drops != nEvents - size) ||
+        (queue.highWater != size)) {
+        error("wrong counts after the burst", 0, 0);
+    }
+    drain();
+}
+
+// Keys without a character in decod are named by row and column
+static void testNames(void) {
+    KEY_EVENT ev = { 0, 0, 0, 0 };
+    char name[8];
+    if (strcmp(keyName(&ev, name), "1") != 0) {
+        error("wrong name", 0, 0);
+    }
+    ev.row = nRows - 1;
+    ev.column = nColumns - 1;
+    keyName(&ev, name);
+    printf("Key at row %d column %d is '%s'\n", ev.row, ev.column, name);
+    if ((nRows > 4) && (strcmp(name, "R15C7") != 0)) {
+        error("wrong name", ev.row, ev.column);
+    }
+}
+
+int main(void) {
+    long nAmbiguous = 0, heldBack = 0;
+
+    printf("Keypad test %dx%d\n", nRows, nColumns);
+    srand(7);
+    keypademu_init(firstRow, nRows, firstColumn, nColumns);
+    init();
+    now = SCAN_PERIOD_US;
+    minErr = INT32_MAX;
+    maxErr = INT32_MIN;
+
+    testNames();
+    for (int i = 0; i < N_CHORDS; i++) {
+        testChord(&nAmbiguous, &heldBack);
+    }
+    printf("%d chords, %ld ambiguous (%ld keys held back), %lu scans with ghosts\n",
+           N_CHORDS, nAmbiguous, heldBack, (unsigned long) ghostScans);
+    printf("Press time error from %ld to %ldus in %ld presses\n",
+           (long) minErr, (long) maxErr, timeChecks);
+    testBurst();
+
+    printf("%ld errors\n", errors);
+    return errors ? 1 : 0;
+}
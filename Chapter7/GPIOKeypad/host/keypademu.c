@@ -0,0 +1,111 @@
+/**
+ * @file keypademu.c
+ * @author Daniel Quadros
+ * @brief Host emulation of the SDK functions used by gpiokeypad.c
+ *        (timer scan) and of a keypad matrix without diodes
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <string.h>
+#include "keypademu.h"
+
+#define MAX_ROWS    16
+#define MAX_COLUMNS 8
+
+static uint32_t now;
+static uint32_t outputs;
+static bool keys[MAX_ROWS][MAX_COLUMNS];
+static uint kpFirstRow, kpRows, kpFirstColumn, kpColumns;
+
+uint32_t time_us_32(void) {
+    return now;
+}
+
+void sleep_ms(uint32_t ms) {
+    now += ms * 1000;
+}
+
+void busy_wait_us_32(uint32_t us) {
+    now += us;
+}
+
+void stdio_init_all(void) {
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                            void *user_data, struct repeating_timer *out) {
+    (void) delay_ms; (void) callback; (void) user_data; (void) out;
+    return true;
+}
+
+bool cancel_repeating_timer(struct repeating_timer *timer) {
+    (void) timer;
+    return true;
+}
+
+void gpio_init_mask(uint32_t mask) {
+    outputs &= ~mask;
+}
+
+void gpio_set_dir_masked(uint32_t mask, uint32_t value) {
+    (void) mask; (void) value;
+}
+
+void gpio_pull_down(uint gpio) {
+    (void) gpio;
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value) {
+    outputs = (outputs & ~mask) | (value & mask);
+}
+
+// The columns read high are the ones connected to a row driven high,
+// following the pressed keys until nothing changes
+uint32_t gpio_get_all(void) {
+    uint32_t rows = 0, cols = 0;
+    for (uint r = 0; r < kpRows; r++) {
+        if (outputs & (1u << (kpFirstRow + r))) {
+            rows |= 1u << r;
+        }
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (uint r = 0; r < kpRows; r++) {
+            for (uint c = 0; c < kpColumns; c++) {
+                if (!keys[r][c]) {
+                    continue;
+                }
+                if ((rows & (1u << r)) && !(cols & (1u << c))) {
+                    cols |= 1u << c;
+                    changed = true;
+                }
+                if ((cols & (1u << c)) && !(rows & (1u << r))) {
+                    rows |= 1u << r;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return outputs | (cols << kpFirstColumn);
+}
+
+void keypademu_init(uint firstRow, uint numRows, uint firstColumn, uint numColumns) {
+    kpFirstRow = firstRow;
+    kpRows = numRows;
+    kpFirstColumn = firstColumn;
+    kpColumns = numColumns;
+    memset(keys, 0, sizeof(keys));
+}
+
+void keypademu_set_key(uint row, uint column, bool pressed) {
+    keys[row][column] = pressed;
+}
+
+void keypademu_advance(uint32_t us) {
+    now += us;
+}
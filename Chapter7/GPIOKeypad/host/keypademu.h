@@ -0,0 +1,65 @@
+/**
+ * @file keypademu.h
+ * @author Daniel Quadros
+ * @brief Host emulation of the SDK functions used by gpiokeypad.c
+ *        (timer scan) and of a keypad matrix without diodes
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _KEYPADEMU_H
+#define _KEYPADEMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// Time
+// The emulation uses a virtual time, advanced by keypademu_advance()
+// and by the waits
+uint32_t time_us_32(void);
+void sleep_ms(uint32_t ms);
+void busy_wait_us_32(uint32_t us);
+static inline void tight_loop_contents(void) {}
+
+// stdio
+void stdio_init_all(void);
+
+// Interrupts (there are none in the host)
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void) status; }
+static inline void __wfi(void) {}
+
+// Repeating timer (not started, the test calls the scan routine)
+struct repeating_timer { int dummy; };
+typedef bool (*repeating_timer_callback_t)(struct repeating_timer *rt);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                            void *user_data, struct repeating_timer *out);
+bool cancel_repeating_timer(struct repeating_timer *timer);
+
+// Clocks
+enum clock_index { clk_sys };
+static inline uint32_t clock_get_hz(enum clock_index clk) { (void) clk; return 125000000; }
+
+// GPIO
+// The rows driven high are connected to the columns through the pressed
+// keys (and through other rows, as there are no diodes)
+#define GPIO_IRQ_EDGE_RISE  8
+void gpio_init_mask(uint32_t mask);
+void gpio_set_dir_masked(uint32_t mask, uint32_t value);
+void gpio_pull_down(uint gpio);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+uint32_t gpio_get_all(void);
+
+// Emulation control
+// The keypad uses rows from 'firstRow' and columns from 'firstColumn'
+void keypademu_init(uint firstRow, uint numRows, uint firstColumn, uint numColumns);
+void keypademu_set_key(uint row, uint column, bool pressed);
+void keypademu_advance(uint32_t us);
+
+#endif
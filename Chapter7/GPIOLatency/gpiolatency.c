@@ -0,0 +1,225 @@
+/**
+ * @file gpiolatency.c
+ * @author Daniel Quadros
+ * @brief Measures the latency from a GPIO edge to the interrupt handler,
+ *        for the SDK callback, a raw handler and a minimal handler in RAM,
+ *        with the XIP cache warm and flushed before each edge
+ *        The edges are generated by PWM; the handler reads the PWM
+ *        counter, that is the number of cycles since the edge
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/iobank0.h"
+#include "hardware/structs/xip_ctrl.h"
+
+// Connections: the PWM output must be connected to the input
+// (the same pin can be used for both, the input works in any function)
+#define OUT_PIN         2
+#define IN_PIN          3
+#define OUT_SLICE       ((OUT_PIN >> 1) & 7)
+
+// PWM period (in cycles), the output rises at the counter wrap
+#define PERIOD_CYCLES   10000
+
+// Samples for each test
+#define N_SAMPLES       10000
+
+// Histogram: bins of 2^BIN_SHIFT processor cycles
+#define BIN_SHIFT       2
+#define N_BINS          512
+
+// Handlers to test
+typedef enum { HANDLER_CALLBACK, HANDLER_RAW, HANDLER_RAM } HANDLER;
+static const char *handlerName[] = { "SDK callback", "Raw handler", "RAM handler" };
+
+// Statistics for a test
+typedef struct {
+    uint32_t hist[N_BINS + 1];      // last bin is overflow
+    volatile uint32_t count;
+    uint32_t min;
+    uint32_t max;
+} LAT_STATS;
+
+static LAT_STATS stats;
+static uint32_t cyclesPerUs;
+
+// Record a latency (in cycles)
+static inline void record(uint32_t cycles) {
+    if (stats.count < N_SAMPLES) {
+        uint32_t bin = cycles >> BIN_SHIFT;
+        stats.hist[bin < N_BINS ? bin : N_BINS]++;
+        if (cycles < stats.min) {
+            stats.min = cycles;
+        }
+        if (cycles > stats.max) {
+            stats.max = cycles;
+        }
+        stats.count++;
+    }
+}
+
+// Callback called by the SDK GPIO interrupt handler
+// (the SDK handler finds the pin and acknowledges the interrupt)
+static void gpio_callback(uint gpio, uint32_t events) {
+    uint32_t cycles = pwm_hw->slice[OUT_SLICE].ctr;
+    record(cycles);
+}
+
+// Raw handler, called by the SDK shared interrupt handler
+// It must check and acknowledge the interrupt
+static void raw_handler(void) {
+    uint32_t cycles = pwm_hw->slice[OUT_SLICE].ctr;
+    if (gpio_get_irq_event_mask(IN_PIN) & GPIO_IRQ_EDGE_RISE) {
+        gpio_acknowledge_irq(IN_PIN, GPIO_IRQ_EDGE_RISE);
+        record(cycles);
+    }
+}
+
+// Minimal handler in RAM, directly in the vector table
+static void __not_in_flash_func(ram_handler)(void) {
+    uint32_t cycles = pwm_hw->slice[OUT_SLICE].ctr;
+    iobank0_hw->intr[IN_PIN / 8] = GPIO_IRQ_EDGE_RISE << (4 * (IN_PIN % 8));
+    record(cycles);
+}
+
+// Install a handler and enable the interrupt
+static void install(HANDLER handler) {
+    // Discard an edge latched while the interrupt was disabled
+    gpio_acknowledge_irq(IN_PIN, GPIO_IRQ_EDGE_RISE);
+    switch (handler) {
+        case HANDLER_CALLBACK:
+            gpio_set_irq_enabled_with_callback(IN_PIN, GPIO_IRQ_EDGE_RISE, true,
+                                               gpio_callback);
+            break;
+        case HANDLER_RAW:
+            gpio_add_raw_irq_handler(IN_PIN, raw_handler);
+            gpio_set_irq_enabled(IN_PIN, GPIO_IRQ_EDGE_RISE, true);
+            irq_set_enabled(IO_IRQ_BANK0, true);
+            break;
+        case HANDLER_RAM:
+            irq_set_exclusive_handler(IO_IRQ_BANK0, ram_handler);
+            gpio_set_irq_enabled(IN_PIN, GPIO_IRQ_EDGE_RISE, true);
+            irq_set_enabled(IO_IRQ_BANK0, true);
+            break;
+    }
+}
+
+// Disable the interrupt and remove the handler
+static void uninstall(HANDLER handler) {
+    gpio_set_irq_enabled(IN_PIN, GPIO_IRQ_EDGE_RISE, false);
+    irq_set_enabled(IO_IRQ_BANK0, false);
+    switch (handler) {
+        case HANDLER_CALLBACK:
+            gpio_set_irq_callback(NULL);
+            break;
+        case HANDLER_RAW:
+            gpio_remove_raw_irq_handler(IN_PIN, raw_handler);
+            break;
+        case HANDLER_RAM:
+            irq_remove_handler(IO_IRQ_BANK0, ram_handler);
+            break;
+    }
+}
+
+// Flush the XIP cache, so the next interrupt will fetch
+// the code from the flash
+static void flush_xip_cache(void) {
+    xip_ctrl_hw->flush = 1;
+    (void) xip_ctrl_hw->flush;      // the read waits for the flush
+}
+
+// Value (in cycles) below which there are 'per1000' thousandths
+// of the samples, taken from the histogram (upper limit of the bin)
+static uint32_t percentile(uint32_t per1000) {
+    uint32_t limit = (uint32_t) (((uint64_t) stats.count * per1000 + 999) / 1000);
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i <= N_BINS; i++) {
+        sum += stats.hist[i];
+        if (sum >= limit) {
+            return (i == N_BINS) ? stats.max : ((i + 1) << BIN_SHIFT) - 1;
+        }
+    }
+    return stats.max;
+}
+
+// Convert cycles to ns
+static inline uint32_t to_ns(uint32_t cycles) {
+    return (uint32_t) (((uint64_t) cycles * 1000) / cyclesPerUs);
+}
+
+// Run a test and show the results
+static void run_test(HANDLER handler, bool flush) {
+    memset(&stats, 0, sizeof(stats));
+    stats.min = UINT32_MAX;
+
+    install(handler);
+    pwm_set_counter(OUT_SLICE, 0);
+    pwm_set_enabled(OUT_SLICE, true);
+    while (stats.count < N_SAMPLES) {
+        if (flush) {
+            // Flush after each sample, before the next edge
+            uint32_t n = stats.count;
+            while (stats.count == n) {
+                tight_loop_contents();
+            }
+            flush_xip_cache();
+        }
+    }
+    pwm_set_enabled(OUT_SLICE, false);
+    uninstall(handler);
+
+    printf("%-13s %-7s %6" PRIu32 " %6" PRIu32 " %6" PRIu32 " %6" PRIu32
+           " %6" PRIu32 " %6" PRIu32 " %6" PRIu32 "\n",
+
+           handlerName[handler], flush ? "flushed" : "warm",
+           to_ns(stats.min), to_ns(percentile(500)), to_ns(percentile(900)),
+           to_ns(percentile(990)), to_ns(percentile(999)), to_ns(stats.max),
+           to_ns(stats.max - stats.min));
+}
+
+// Main program
+int main() {
+    stdio_init_all();
+    cyclesPerUs = clock_get_hz(clk_sys) / 1000000;
+
+    // PWM: short pulse every PERIOD_CYCLES
+    // The output rises when the counter wraps to zero
+    pwm_config c = pwm_get_default_config();
+    pwm_config_set_wrap(&c, PERIOD_CYCLES - 1);
+    pwm_init(OUT_SLICE, &c, false);
+    pwm_set_gpio_level(OUT_PIN, PERIOD_CYCLES / 2);
+    gpio_set_function(OUT_PIN, GPIO_FUNC_PWM);
+
+    // Input
+    if (IN_PIN != OUT_PIN) {
+        gpio_init(IN_PIN);
+        gpio_set_dir(IN_PIN, GPIO_IN);
+    }
+
+    while (true) {
+        printf("\nGPIO Interrupt Latency Benchmark\n");
+        printf("%d samples per test, clk_sys = %" PRIu32 "MHz\n"
+, N_SAMPLES, cyclesPerUs);
+        printf("(latency from the PWM edge, in ns)\n");
+        printf("handler       XIP        min    p50    p90    p99  p99.9    max jitter\n");
+        for (int h = HANDLER_CALLBACK; h <= HANDLER_RAM; h++) {
+            run_test(h, false);
+            run_test(h, true);
+        }
+        sleep_ms(10000);
+    }
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file shiftdemo.c
+ * @author Daniel Quadros
+ * @brief Example of driving a chain of 8 digit 7 segment modules
+ *        (two 74HC595 each) with PIO and DMA, and benchmark of the
+ *        CPU cost compared to refreshing by software
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "shiftdisp.h"
+
+// Display connections (the 74HC595 OE pins are tied to GND)
+#define DATA_PIN    2
+#define CLOCK_PIN   3
+#define LATCH_PIN   4
+
+// Display configuration
+#define MODULES     4
+#define REFRESH_HZ  200
+
+// Content updates per second in the demo
+#define UPDATE_HZ   10
+
+// Time to measure the load (ms)
+#define LOAD_MS     2000
+
+// Local routines
+static uint32_t idle_count(void);
+static void soft_frame(uint modules);
+static void benchmark(void);
+static void render(uint32_t n);
+
+// Main Program
+int main() {
+    stdio_init_all();
+    while (!stdio_usb_connected()) {
+        sleep_ms(100);
+    }
+    printf("\nShift Register Display Demo\n\n");
+
+    benchmark();
+
+    uint32_t n = 0;
+    while (1) {
+        render(n++);
+        shiftdisp_show();
+        sleep_ms(1000 / UPDATE_HZ);
+    }
+    return 0;
+}
+
+// Count loop iterations for LOAD_MS; with interrupts and DMA
+// taking CPU time there will be less iterations
+static uint32_t idle_count(void) {
+    uint32_t count = 0;
+    absolute_time_t end = make_timeout_time_ms(LOAD_MS);
+    while (!time_reached(end)) {
+        count++;
+    }
+    return count;
+}
+
+// Draw the demo content: a counter, the uptime and a text
+static void render(uint32_t n) {
+    char text[20];
+    uint32_t secs = to_ms_since_boot(get_absolute_time()) / 1000;
+    shiftdisp_clear();
+    shiftdisp_put_number(0, 8, n);
+    snprintf(text, sizeof(text), "%02" PRIu32 ".%02" PRIu32 ".%02" PRIu32,
+
+             secs / 3600, (secs / 60) % 60, secs % 60);
+    shiftdisp_put_text(10, text);
+    for (uint pos = 16; pos < shiftdisp_digits(); pos += 8) {
+        shiftdisp_put_text(pos, "PICO 595");
+    }
+}
+
+// Shift a frame by software, as would be done in a timer interrupt
+// to refresh the display without the PIO
+static void soft_frame(uint modules) {
+    for (uint line = 0; line < SHIFTDISP_LINES; line++) {
+        for (uint b = 0; b < 16*modules; b++) {
+            gpio_put(DATA_PIN, b & 1);
+            gpio_put(CLOCK_PIN, 1);
+            gpio_put(CLOCK_PIN, 0);
+        }
+        gpio_put(LATCH_PIN, 1);
+        gpio_put(LATCH_PIN, 0);
+    }
+}
+
+// Compare the CPU cost of the refresh
+// Result is digits refreshed per second per CPU percent
+static void benchmark(void) {
+    uint32_t base = idle_count();
+
+    // Software refresh (before the PIO takes the pins)
+    gpio_init_mask((1u << DATA_PIN) | (1u << CLOCK_PIN) | (1u << LATCH_PIN));
+    gpio_set_dir_out_masked((1u << DATA_PIN) | (1u << CLOCK_PIN) | (1u << LATCH_PIN));
+    uint32_t start = time_us_32();
+    for (int i = 0; i < 100; i++) {
+        soft_frame(MODULES);
+    }
+    float softFrameUs = (time_us_32() - start) / 100.0f;
+    float softCpu = softFrameUs * REFRESH_HZ / 10000.0f;
+
+    // PIO + DMA refresh
+    shiftdisp_init(pio0, DATA_PIN, CLOCK_PIN, LATCH_PIN, MODULES, REFRESH_HZ);
+    float digitsPerSec = shiftdisp_digits() * shiftdisp_refresh_hz();
+    uint32_t loaded = idle_count();
+    float dmaCpu = (loaded < base) ? 100.0f * (float) (base - loaded) / base : 0.0f;
+
+    // Cost of changing the content
+    // The updates are two frames apart, so shiftdisp_show() does not
+    // wait for the DMA to start the previous frame
+    uint32_t gapUs = (uint32_t) (2000000.0f / shiftdisp_refresh_hz());
+    uint32_t updateTotal = 0;
+    for (int i = 0; i < 100; i++) {
+        sleep_us(gapUs);
+        start = time_us_32();
+        render(i);
+        shiftdisp_show();
+        updateTotal += time_us_32() - start;
+    }
+    float updateUs = updateTotal / 100.0f;
+    float updateCpu = updateUs * UPDATE_HZ / 10000.0f;
+    float pioCpu = dmaCpu + updateCpu;
+
+    printf("%u digits at %.1f Hz: %.0f digits/s\n", shiftdisp_digits(),
+           shiftdisp_refresh_hz(), digitsPerSec);
+    printf("Software: %.1f us/frame, %.2f%% CPU, %.0f digits/s per %%CPU\n",
+           softFrameUs, softCpu, digitsPerSec / softCpu);
+    printf("PIO+DMA:  refresh %.3f%% CPU, update %.1f us (%.3f%% CPU at %d Hz)",
+           dmaCpu, updateUs, updateCpu, UPDATE_HZ);
+    if (pioCpu > 0.0f) {
+        printf(", %.0f digits/s per %%CPU\n\n", digitsPerSec / pioCpu);
+    } else {
+        printf("\n\n");
+    }
+}
@@ -0,0 +1,224 @@
+/**
+ * @file shiftdisp.c
+ * @author Daniel Quadros
+ * @brief Driver for multiplexed displays connected through a chain of
+ *        74HC595 shift registers, refreshed by PIO and DMA
+ *        The PIO shifts a line (one digit of each module) and latches it,
+ *        the digit stays on while the next line is shifted. The DMA feeds
+ *        the frame continuously, the CPU is only used when the content
+ *        changes.
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "shiftdisp.h"
+
+// Our PIO program:
+#include "shiftout.pio.h"
+
+// Bytes shifted for each line
+#define LINE_BYTES(m)   (2*(m))
+#define MAX_FRAME       (SHIFTDISP_LINES*LINE_BYTES(SHIFTDISP_MAX_MODULES))
+
+// Active levels
+#define SEG_XOR     (SHIFTDISP_SEG_ACTIVE_LOW ? 0xFF : 0x00)
+#define SEL_XOR     (SHIFTDISP_SEL_ACTIVE_LOW ? 0xFF : 0x00)
+
+// Characters 0x20 to 0x5F, lowercase letters use the uppercase ones
+static const uint8_t font[64] = {
+    0x00, 0x82, 0x22, 0x00, 0x6D, 0x00, 0x00, 0x02,     //  !"#$%&'
+    0x39, 0x0F, 0x00, 0x00, 0x80, 0x40, 0x80, 0x52,     // ()*+,-./
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07,     // 01234567
+    0x7F, 0x6F, 0x00, 0x00, 0x00, 0x48, 0x00, 0x53,     // 89:;<=>?
+    0x00, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71, 0x3D,     // @ABCDEFG
+    0x76, 0x06, 0x1E, 0x75, 0x38, 0x37, 0x54, 0x3F,     // HIJKLMNO
+    0x73, 0x67, 0x50, 0x6D, 0x78, 0x3E, 0x1C, 0x2A,     // PQRSTUVW
+    0x76, 0x6E, 0x5B, 0x39, 0x64, 0x0F, 0x23, 0x08      // XYZ[\]^_
+};
+
+// Display state
+static uint nModules;
+static uint frameLen;
+static uint dataChan;
+static float refreshHz;
+
+// Framebuffer (what the user draws) and the two frames in the
+// shift order (one is being sent by the DMA)
+static uint8_t fb[SHIFTDISP_MAX_DIGITS];
+static uint8_t frame[2][MAX_FRAME];
+static uint8_t *volatile activeFrame;
+static int back;
+
+// Local routines
+static void build_frame(uint8_t *f);
+
+// Init the display and start the refresh
+void shiftdisp_init(PIO pio, uint dataPin, uint clockPin, uint latchPin,
+                    uint modules, uint refresh) {
+    if (modules > SHIFTDISP_MAX_MODULES) {
+        modules = SHIFTDISP_MAX_MODULES;
+    }
+    nModules = modules;
+    frameLen = SHIFTDISP_LINES * LINE_BYTES(modules);
+
+    // Start with a blank display
+    shiftdisp_clear();
+    build_frame(frame[0]);
+    build_frame(frame[1]);
+    activeFrame = frame[0];
+    back = 1;
+
+    // Start the PIO, the clock is set for the refresh rate
+    uint bits = 8 * LINE_BYTES(modules);
+    float freq = (float) refresh * SHIFTDISP_LINES * SHIFTOUT_LINE_CYCLES(bits);
+    uint offset = pio_add_program(pio, &shiftout_program);
+    uint sm = pio_claim_unused_sm(pio, true);
+    shiftout_program_init(pio, sm, offset, dataPin, clockPin, latchPin, bits, freq);
+    float div = clock_get_hz(clk_sys) / freq;
+    refreshHz = clock_get_hz(clk_sys) / (div * SHIFTDISP_LINES * SHIFTOUT_LINE_CYCLES(bits));
+
+    // Data channel: sends the frame to the PIO, a byte at a time
+    dataChan = dma_claim_unused_channel(true);
+    int ctrlChan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(dataChan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    channel_config_set_chain_to(&c, ctrlChan);
+    dma_channel_configure(dataChan, &c, &pio->txf[sm], activeFrame, frameLen, false);
+
+    // Control channel: restarts the data channel at the active frame
+    // (the transfer count is reloaded when the channel is triggered)
+    c = dma_channel_get_default_config(ctrlChan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(ctrlChan, &c, &dma_hw->ch[dataChan].al3_read_addr_trig,
+                          &activeFrame, 1, false);
+
+    // From now on the display is refreshed without the CPU
+    dma_channel_start(dataChan);
+}
+
+// Number of digits (or matrix rows)
+uint shiftdisp_digits(void) {
+    return nModules * SHIFTDISP_LINES;
+}
+
+// Actual refresh rate
+float shiftdisp_refresh_hz(void) {
+    return refreshHz;
+}
+
+// Framebuffer
+uint8_t *shiftdisp_framebuffer(void) {
+    return fb;
+}
+
+// Clear the framebuffer
+void shiftdisp_clear(void) {
+    memset(fb, 0, sizeof(fb));
+}
+
+// Segments for a character
+uint8_t shiftdisp_font(char c) {
+    if ((c >= 'a') && (c <= 'z')) {
+        c -= 'a' - 'A';
+    }
+    if ((c < 0x20) || (c > 0x5F)) {
+        return 0;
+    }
+    return font[c - 0x20];
+}
+
+// Write a number right aligned in 'width' digits starting at 'pos'
+bool shiftdisp_put_number(uint pos, uint width, int32_t value) {
+    uint digits = shiftdisp_digits();
+    if ((pos >= digits) || (width == 0)) {
+        return false;
+    }
+    if (pos + width > digits) {
+        width = digits - pos;
+    }
+    uint32_t n = (value < 0) ? -(uint32_t) value : (uint32_t) value;
+    int i = pos + width - 1;
+    do {
+        fb[i--] = font['0' - 0x20 + (n % 10)];
+        n /= 10;
+    } while ((n != 0) && (i >= (int) pos));
+    if (value < 0) {
+        if (i >= (int) pos) {
+            fb[i--] = font['-' - 0x20];
+        } else {
+            n = 1;      // no space for the sign
+        }
+    }
+    if (n != 0) {
+        memset(fb + pos, font['-' - 0x20], width);
+        return false;
+    }
+    while (i >= (int) pos) {
+        fb[i--] = 0;
+    }
+    return true;
+}
+
+// Write text starting at 'pos'
+uint shiftdisp_put_text(uint pos, const char *text) {
+    uint digits = shiftdisp_digits();
+    uint start = pos;
+    for (; *text; text++) {
+        if ((*text == '.') && (pos > start) && !(fb[pos-1] & SEG_DP)) {
+            fb[pos-1] |= SEG_DP;
+            continue;
+        }
+        if (pos >= digits) {
+            break;
+        }
+        fb[pos++] = shiftdisp_font(*text);
+    }
+    return pos - start;
+}
+
+// Show the framebuffer
+void shiftdisp_show(void) {
+    // Make sure the DMA is not still sending the back frame
+    // (it will be at most one frame if show is called too often)
+    uint32_t active = (uint32_t) activeFrame;
+    uint32_t addr;
+    do {
+        addr = dma_hw->ch[dataChan].read_addr;
+    } while ((addr < active) || (addr > active + frameLen));
+
+    // Build the new frame and tell the control channel to use it
+    build_frame(frame[back]);
+    activeFrame = frame[back];
+    back ^= 1;
+}
+
+// Convert the framebuffer to the shift order
+// The first bytes shifted go to the last module
+static void build_frame(uint8_t *f) {
+    for (uint line = 0; line < SHIFTDISP_LINES; line++) {
+        uint8_t sel = (1u << line) ^ SEL_XOR;
+        for (int m = nModules - 1; m >= 0; m--) {
+            uint8_t seg = fb[m*SHIFTDISP_LINES + line] ^ SEG_XOR;
+#if SHIFTDISP_SEG_FIRST
+            *f++ = sel;
+            *f++ = seg;
+#else
+            *f++ = seg;
+            *f++ = sel;
+#endif
+        }
+    }
+}
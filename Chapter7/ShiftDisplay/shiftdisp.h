@@ -0,0 +1,78 @@
+/**
+ * @file shiftdisp.h
+ * @author Daniel Quadros
+ * @brief Driver for multiplexed displays connected through a chain of
+ *        74HC595 shift registers, refreshed by PIO and DMA
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _SHIFTDISP_H
+#define _SHIFTDISP_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+// The display is made of modules, each one with two 74HC595: one drives
+// the segments (or the columns of a 8x8 LED matrix) and the other selects
+// one of the 8 digits (or rows). The modules are daisy chained, module 0
+// is the one connected to the Pico.
+#define SHIFTDISP_LINES         8
+#define SHIFTDISP_MAX_MODULES   16
+#define SHIFTDISP_MAX_DIGITS    (SHIFTDISP_LINES*SHIFTDISP_MAX_MODULES)
+
+// Module wiring: output active levels and which register receives
+// the data first (is connected to the module input)
+#define SHIFTDISP_SEG_ACTIVE_LOW    1   // common anode digits
+#define SHIFTDISP_SEL_ACTIVE_LOW    0
+#define SHIFTDISP_SEG_FIRST         1
+
+// Segments, Qa (bit 0) to Qh (bit 7)
+#define SEG_A   0x01
+#define SEG_B   0x02
+#define SEG_C   0x04
+#define SEG_D   0x08
+#define SEG_E   0x10
+#define SEG_F   0x20
+#define SEG_G   0x40
+#define SEG_DP  0x80
+
+// Init the display and start the refresh
+// The refresh rate (full frames per second) does not depend on the
+// number of modules, the shift clock is adjusted for it
+void shiftdisp_init(PIO pio, uint dataPin, uint clockPin, uint latchPin,
+                    uint modules, uint refreshHz);
+
+// Number of digits (or matrix rows)
+uint shiftdisp_digits(void);
+
+// Actual refresh rate (frames per second)
+float shiftdisp_refresh_hz(void);
+
+// Framebuffer, one byte per digit (segments) or matrix row (columns)
+// Digit 'n' is line n%8 of module n/8
+// Changes are only shown after shiftdisp_show()
+uint8_t *shiftdisp_framebuffer(void);
+
+// Clear the framebuffer
+void shiftdisp_clear(void);
+
+// Segments for a character (0 if it cannot be shown)
+uint8_t shiftdisp_font(char c);
+
+// Write a number right aligned in 'width' digits starting at 'pos'
+// Returns false (and fills with '-') if it does not fit
+bool shiftdisp_put_number(uint pos, uint width, int32_t value);
+
+// Write text starting at 'pos', a '.' turns on the decimal point of
+// the previous digit. Returns the number of digits used
+uint shiftdisp_put_text(uint pos, const char *text);
+
+// Show the framebuffer, the display changes at the end of the frame
+// being refreshed
+void shiftdisp_show(void);
+
+#endif
@@ -12,6 +12,7 @@
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 #include "hardware/clocks.h"
+#include "clkgating.h"
 
 // Our PIO program:
 #include "squarewave.pio.h"
@@ -19,8 +20,23 @@
 // Output pin
 #define GPIO_WAVE_OUT   28
 
+// Set to 0 to keep all peripherals clocked (to compare the current)
+#define CLOCK_GATING    1
+
+// Only clock the blocks we use (PLL_SYS and PIO0 besides the core ones)
+// SLEEP_EN controls the clocks while the processor is in __wfe/__wfi
+static void clock_gating(void) {
+    #if CLOCK_GATING
+    clkgating_enable(CLOCKS_WAKE_EN0_CLK_SYS_PLL_SYS_BITS |
+                     CLOCKS_WAKE_EN0_CLK_SYS_PIO0_BITS, 0);
+    #endif
+}
+
 
 int main() {
+    // Turn off the clocks of the unused peripherals
+    clock_gating();
+
     // Choose which PIO instance to use (there are two instances)
     PIO pio = pio0;
 
@@ -0,0 +1,53 @@
+/**
+ * @file clkgating.h
+ * @author Daniel Quadros
+ * @brief Clock gating of the unused peripherals (WAKE_EN/SLEEP_EN)
+ *        Shared by the Sleep and SquareWave examples
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _CLKGATING_H
+#define _CLKGATING_H
+
+#include "pico/stdlib.h"
+#include "hardware/structs/clocks.h"
+
+// Clocks needed by the processors, memories, bus and the blocks
+// used in the SDK initialization and the timer
+// The clock source (PLL_SYS or ROSC) is added by the example
+// The WAKE_EN and SLEEP_EN registers have the same bits
+#define CLK_EN0_CORE  (CLOCKS_WAKE_EN0_CLK_SYS_SRAM3_BITS |         \
+                       CLOCKS_WAKE_EN0_CLK_SYS_SRAM2_BITS |         \
+                       CLOCKS_WAKE_EN0_CLK_SYS_SRAM1_BITS |         \
+                       CLOCKS_WAKE_EN0_CLK_SYS_SRAM0_BITS |         \
+                       CLOCKS_WAKE_EN0_CLK_SYS_SIO_BITS |           \
+                       CLOCKS_WAKE_EN0_CLK_SYS_ROM_BITS |           \
+                       CLOCKS_WAKE_EN0_CLK_SYS_RESETS_BITS |        \
+                       CLOCKS_WAKE_EN0_CLK_SYS_PSM_BITS |           \
+                       CLOCKS_WAKE_EN0_CLK_SYS_PADS_BITS |          \
+                       CLOCKS_WAKE_EN0_CLK_SYS_VREG_AND_CHIP_RESET_BITS | \
+                       CLOCKS_WAKE_EN0_CLK_SYS_IO_BITS |            \
+                       CLOCKS_WAKE_EN0_CLK_SYS_BUSFABRIC_BITS |     \
+                       CLOCKS_WAKE_EN0_CLK_SYS_BUSCTRL_BITS |       \
+                       CLOCKS_WAKE_EN0_CLK_SYS_CLOCKS_BITS)
+#define CLK_EN1_CORE  (CLOCKS_WAKE_EN1_CLK_SYS_XOSC_BITS |          \
+                       CLOCKS_WAKE_EN1_CLK_SYS_XIP_BITS |           \
+                       CLOCKS_WAKE_EN1_CLK_SYS_WATCHDOG_BITS |      \
+                       CLOCKS_WAKE_EN1_CLK_SYS_TIMER_BITS |         \
+                       CLOCKS_WAKE_EN1_CLK_SYS_SRAM5_BITS |         \
+                       CLOCKS_WAKE_EN1_CLK_SYS_SRAM4_BITS)
+
+// Clock only the core blocks and the ones in en0/en1, both awake
+// and while the processor is in __wfe/__wfi
+static inline void clkgating_enable(uint32_t en0, uint32_t en1) {
+    clocks_hw->wake_en0 = CLK_EN0_CORE | en0;
+    clocks_hw->wake_en1 = CLK_EN1_CORE | en1;
+    clocks_hw->sleep_en0 = CLK_EN0_CORE | en0;
+    clocks_hw->sleep_en1 = CLK_EN1_CORE | en1;
+}
+
+#endif
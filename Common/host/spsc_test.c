@@ -0,0 +1,136 @@
+/**
+ * @file spsc_test.c
+ * @author Daniel Quadros
+ * @brief Test and benchmark of spscring.h in the host
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ * A producer thread puts numbered items in a small ring (retrying when
+ * it is full) and the main thread checks that it gets all of them, in
+ * order and intact. The indexes start near the 32 bit limit, so they
+ * wrap around during the test. The full ring, the drop count and the
+ * high water mark are checked in a single thread.
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "spscring.h"
+
+// Items to pass between the threads
+#define N_ITEMS     2000000u
+
+// Item with redundancy to detect torn copies
+typedef struct {
+    uint32_t seq;
+    uint32_t time;
+    uint32_t check;
+} ITEM;
+
+#define ITEM_CHECK(seq)     ((seq) ^ 0xA5A5A5A5u)
+
+SPSC_RING_DEFINE(ring, ITEM, 6);
+
+static long errors;
+
+static void fail(uint32_t n, const char *msg) {
+    if (errors < 20) {
+        printf("%u: %s\n", n, msg);
+    }
+    errors++;
+}
+
+// Current time in nanoseconds
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// Producer thread
+static void *producer(void *arg) {
+    (void) arg;
+    uint32_t seq = 0;
+    while (seq < N_ITEMS) {
+        ITEM item = { seq, seq * 3u, ITEM_CHECK(seq) };
+        if (spsc_put(&ring, &item)) {
+            seq++;
+        } else {
+            sched_yield();      // let the consumer run (if a single CPU)
+        }
+    }
+    return NULL;
+}
+
+// Single thread checks of the full ring
+static void check_full(void) {
+    ITEM item = { 0, 0, 0 };
+    uint32_t size = ring.mask + 1;
+    for (uint32_t i = 0; i < size; i++) {
+        item.seq = i;
+        if (!spsc_put(&ring, &item)) {
+            fail(i, "put failed before the ring was full");
+        }
+    }
+    if (spsc_put(&ring, &item) || (ring.drops != 1)) {
+        fail(size, "full ring not detected");
+    }
+    if ((spsc_count(&ring) != size) || (ring.highWater != size)) {
+        fail(size, "wrong count or high water");
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        if (!spsc_get(&ring, &item) || (item.seq != i)) {
+            fail(i, "wrong item from the full ring");
+        }
+    }
+    if (spsc_get(&ring, &item) || (spsc_count(&ring) != 0)) {
+        fail(size, "empty ring not detected");
+    }
+}
+
+int main(void) {
+    // Start near the limit, so the indexes wrap around
+    ring.in = ring.out = 0xFFFFFF00u;
+    check_full();
+
+    // Stress test with two threads
+    ring.drops = 0;
+    uint32_t start = spsc_total(&ring);
+    pthread_t thread;
+    uint64_t t0 = now_ns();
+    pthread_create(&thread, NULL, producer, NULL);
+    uint32_t expected = 0;
+    ITEM item;
+    while (expected < N_ITEMS) {
+        if (spsc_get(&ring, &item)) {
+            if ((item.seq != expected) || (item.time != expected * 3u) ||
+                (item.check != ITEM_CHECK(expected))) {
+                fail(expected, "item lost, out of order or torn");
+                expected = item.seq;
+            }
+            expected++;
+        } else {
+            sched_yield();
+        }
+    }
+    pthread_join(thread, NULL);
+    uint64_t elapsed = now_ns() - t0;
+    if ((spsc_total(&ring) - start) != N_ITEMS) {
+        fail(N_ITEMS, "wrong total");
+    }
+    if (spsc_count(&ring) != 0) {
+        fail(N_ITEMS, "ring not empty at the end");
+    }
+
+    printf("%u items, %u times full, %ld errors\n", N_ITEMS, ring.drops, errors);
+    printf("%.1f million items/s (put + get, %ld CPUs)\n",
+           N_ITEMS * 1000.0 / elapsed, sysconf(_SC_NPROCESSORS_ONLN));
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
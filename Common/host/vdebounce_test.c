@@ -0,0 +1,129 @@
+/**
+ * @file vdebounce_test.c
+ * @author Daniel Quadros
+ * @brief Test of vdebounce.h in the host
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ * The 32 inputs get square waves with different periods and random
+ * bounces; the result of each sample is compared with a reference that
+ * keeps a counter of consecutive different samples for each input.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vdebounce.h"
+
+#define N_SAMPLES   2000000L
+
+static long errors;
+
+static void fail(long t, const char *msg) {
+    if (errors < 20) {
+        printf("sample %ld: %s\n", t, msg);
+    }
+    errors++;
+}
+
+// Input with bounces: square wave of period 2*(50+7*i) samples, each
+// sample inverted with probability 1/(i+2)
+static uint32_t make_sample(long t) {
+    uint32_t sample = 0;
+    for (int i = 0; i < 32; i++) {
+        int level = (t / (50 + i*7)) & 1;
+        if ((rand() % (i + 2)) == 0) {
+            level ^= 1;
+        }
+        sample |= (uint32_t) level << i;
+    }
+    return sample;
+}
+
+// Edge cases for one input
+static void check_edges(void) {
+    VDEBOUNCE d;
+    vdebounce_init(&d, 0);
+
+    // VDEBOUNCE_SAMPLES-1 samples followed by a glitch do not change the state
+    for (int i = 0; i < VDEBOUNCE_SAMPLES - 1; i++) {
+        if (vdebounce_update(&d, 1)) {
+            fail(i, "changed too early");
+        }
+    }
+    if (vdebounce_update(&d, 0) || (d.state != 0)) {
+        fail(0, "glitch changed the state");
+    }
+
+    // Exactly VDEBOUNCE_SAMPLES samples change the state
+    for (int i = 0; i < VDEBOUNCE_SAMPLES; i++) {
+        uint32_t changed = vdebounce_update(&d, 1);
+        if (changed != ((i == VDEBOUNCE_SAMPLES - 1) ? 1u : 0u)) {
+            fail(i, "press not seen after VDEBOUNCE_SAMPLES samples");
+        }
+    }
+    if (d.state != 1) {
+        fail(0, "state not pressed");
+    }
+
+    // Init with a state
+    vdebounce_init(&d, 0xA5A5A5A5u);
+    if (vdebounce_update(&d, 0xA5A5A5A5u) || (d.state != 0xA5A5A5A5u)) {
+        fail(0, "init state not kept");
+    }
+}
+
+int main(void) {
+    VDEBOUNCE d;
+    uint32_t ref = 0;
+    int cnt[32] = { 0 };
+    uint32_t nChanges = 0;
+
+    check_edges();
+
+    srand(1);
+    vdebounce_init(&d, 0);
+    for (long t = 0; t < N_SAMPLES; t++) {
+        uint32_t sample = make_sample(t);
+        uint32_t changed = vdebounce_update(&d, sample);
+
+        // Reference
+        uint32_t refChanged = 0;
+        for (int i = 0; i < 32; i++) {
+            if (((sample ^ ref) >> i) & 1) {
+                if (++cnt[i] == VDEBOUNCE_SAMPLES) {
+                    ref ^= 1u << i;
+                    refChanged |= 1u << i;
+                    cnt[i] = 0;
+                }
+            } else {
+                cnt[i] = 0;
+            }
+        }
+        if ((changed != refChanged) || (d.state != ref)) {
+            fail(t, "differs from the reference");
+        }
+
+        // Pressed and released split the changes
+        uint32_t pressed = vdebounce_pressed(&d, changed);
+        uint32_t released = vdebounce_released(&d, changed);
+        if (((pressed | released) != changed) || (pressed & released)) {
+            fail(t, "wrong pressed/released");
+        }
+        uint32_t mask = changed;
+        uint32_t seen = 0;
+        while (mask) {
+            int n = vdebounce_next(&mask);
+            seen |= 1u << n;
+            nChanges++;
+        }
+        if (seen != changed) {
+            fail(t, "vdebounce_next lost an input");
+        }
+    }
+
+    printf("%ld samples, %u changes, %ld errors\n", N_SAMPLES, nChanges, errors);
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
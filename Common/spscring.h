@@ -0,0 +1,81 @@
+/**
+ * @file spscring.h
+ * @author Daniel Quadros
+ * @brief Lock-free ring for one producer and one consumer (for example
+ *        an interrupt handler and the main loop, or the two cores)
+ *        The size is a power of two, the indexes run free and the
+ *        position is the index masked by the size
+ *        Shared by the GPIOInterrupt and GPIOKeypad examples
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _SPSCRING_H
+#define _SPSCRING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Ring control, the items are in a separate buffer
+typedef struct {
+    void *buf;
+    uint32_t itemSize;
+    uint32_t mask;              // number of items - 1
+    uint32_t in;                // written by the producer only
+    uint32_t out;               // written by the consumer only
+    uint32_t drops;             // items discarded because the ring was full
+    uint32_t highWater;         // maximum number of items in the ring
+} SPSC_RING;
+
+// Define a ring 'name' with 2^bits items of 'type'
+#define SPSC_RING_DEFINE(name, type, bits)                          \
+    static type name##_buf[1u << (bits)];                           \
+    static SPSC_RING name = { name##_buf, sizeof(type), (1u << (bits)) - 1, 0, 0, 0, 0 }
+
+// Put an item in the ring (producer)
+// Returns false, and counts a drop, if the ring is full
+static inline bool spsc_put(SPSC_RING *r, const void *item) {
+    uint32_t in = r->in;
+    uint32_t used = in - __atomic_load_n(&r->out, __ATOMIC_ACQUIRE);
+    if (used > r->mask) {
+        r->drops++;
+        return false;
+    }
+    memcpy((uint8_t *) r->buf + (in & r->mask) * r->itemSize, item, r->itemSize);
+    if (used >= r->highWater) {
+        r->highWater = used + 1;
+    }
+    // the item must be written before the index
+    __atomic_store_n(&r->in, in + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Get an item from the ring (consumer)
+// Returns false if the ring is empty
+static inline bool spsc_get(SPSC_RING *r, void *item) {
+    uint32_t out = r->out;
+    if (out == __atomic_load_n(&r->in, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    memcpy(item, (uint8_t *) r->buf + (out & r->mask) * r->itemSize, r->itemSize);
+    // the item must be read before the position is released
+    __atomic_store_n(&r->out, out + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Number of items in the ring
+static inline uint32_t spsc_count(SPSC_RING *r) {
+    return __atomic_load_n(&r->in, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&r->out, __ATOMIC_ACQUIRE);
+}
+
+// Total number of items put in the ring
+static inline uint32_t spsc_total(SPSC_RING *r) {
+    return __atomic_load_n(&r->in, __ATOMIC_ACQUIRE);
+}
+
+#endif
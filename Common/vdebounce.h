@@ -0,0 +1,72 @@
+/**
+ * @file vdebounce.h
+ * @author Daniel Quadros
+ * @brief Debounce of up to 32 inputs in parallel with vertical counters
+ *        Each input has a 3 bit counter, spread over three words, so all
+ *        inputs are debounced with a few logic instructions per sample
+ *        Shared by the GPIOKeypad and Sleep examples
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026, Daniel Quadros
+ * 
+ */
+
+#ifndef _VDEBOUNCE_H
+#define _VDEBOUNCE_H
+
+#include <stdint.h>
+
+// An input changes state after this number of consecutive samples
+// different from the current state
+#define VDEBOUNCE_SAMPLES   8
+
+// Debounce state (bit n is input n)
+typedef struct {
+    uint32_t state;         // debounced state
+    uint32_t cnt0;          // counters, counting down from 7
+    uint32_t cnt1;
+    uint32_t cnt2;
+} VDEBOUNCE;
+
+// Init the debounce, with 'sample' as the current state
+static inline void vdebounce_init(VDEBOUNCE *d, uint32_t sample) {
+    d->state = sample;
+    d->cnt0 = d->cnt1 = d->cnt2 = 0xFFFFFFFF;
+}
+
+// Process a new sample, returns the inputs that changed state
+// The counters of inputs that agree with the state are reset, the
+// others are decremented; the state changes when a counter rolls over
+static inline uint32_t vdebounce_update(VDEBOUNCE *d, uint32_t sample) {
+    uint32_t delta = sample ^ d->state;
+    uint32_t b0 = ~d->cnt0;             // borrows
+    uint32_t b1 = b0 & ~d->cnt1;
+    uint32_t b2 = b1 & ~d->cnt2;
+    d->cnt0 = ~(d->cnt0 & delta);
+    d->cnt1 = (d->cnt1 ^ b0) | ~delta;
+    d->cnt2 = (d->cnt2 ^ b1) | ~delta;
+    uint32_t changed = delta & b2;
+    d->state ^= changed;
+    return changed;
+}
+
+// Inputs that changed to 1 (pressed)
+static inline uint32_t vdebounce_pressed(const VDEBOUNCE *d, uint32_t changed) {
+    return changed & d->state;
+}
+
+// Inputs that changed to 0 (released)
+static inline uint32_t vdebounce_released(const VDEBOUNCE *d, uint32_t changed) {
+    return changed & ~d->state;
+}
+
+// Get the lowest input in a mask and remove it, 'mask' must not be zero
+// Use as: while (mask) { int n = vdebounce_next(&mask); ... }
+static inline int vdebounce_next(uint32_t *mask) {
+    int n = __builtin_ctz(*mask);
+    *mask &= *mask - 1;
+    return n;
+}
+
+#endif